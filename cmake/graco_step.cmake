@@ -76,4 +76,64 @@ add_graco_double_step
 		)
 endmacro()
 
+# same as add_graco_double_step, but the second (source) frame is sharded into
+# _SHARD_COUNT translation units: the first one is _OUTPUT_FILE_NAME_2, the rest
+# get the shard index inserted before the extension (parser.cpp -> parser.1.cpp)
+# and are listed in GRACO_SHARD_OUTPUT_LIST
+
+macro(
+add_graco_sharded_double_step
+	_OUTPUT_FILE_NAME_1
+	_OUTPUT_FILE_NAME_2
+	_FRAME_FILE_NAME_1
+	_FRAME_FILE_NAME_2
+	_SHARD_COUNT
+	_INPUT_FILE_NAME
+	# ...
+)
+
+	set(_INPUT_PATH    "${CMAKE_CURRENT_SOURCE_DIR}/${_INPUT_FILE_NAME}")
+	set(_FRAME_PATH_1  "${GRACO_FRAME_DIR}/${_FRAME_FILE_NAME_1}")
+	set(_FRAME_PATH_2  "${GRACO_FRAME_DIR}/${_FRAME_FILE_NAME_2}")
+	set(_OUTPUT_PATH_1 "${CMAKE_CURRENT_BINARY_DIR}/${_OUTPUT_FILE_NAME_1}")
+	set(_OUTPUT_PATH_2 "${CMAKE_CURRENT_BINARY_DIR}/${_OUTPUT_FILE_NAME_2}")
+	set(_DEPENDENCY_LIST ${ARGN})
+
+	if(TARGET graco)
+		list(APPEND _DEPENDENCY_LIST graco)
+	endif()
+
+	set(GRACO_SHARD_OUTPUT_LIST)
+	set(_SHARD_ARG_LIST)
+
+	if(${_SHARD_COUNT} GREATER 1)
+		math(EXPR _LAST_SHARD "${_SHARD_COUNT} - 1")
+
+		foreach(_SHARD RANGE 1 ${_LAST_SHARD})
+			string(REGEX REPLACE "(\\.[^./]*)$" ".${_SHARD}\\1" _SHARD_PATH ${_OUTPUT_PATH_2})
+			list(APPEND GRACO_SHARD_OUTPUT_LIST ${_SHARD_PATH})
+			list(APPEND _SHARD_ARG_LIST -o${_SHARD_PATH} -f${_FRAME_PATH_2})
+		endforeach()
+	endif()
+
+	add_custom_command(
+		OUTPUT
+			${_OUTPUT_PATH_1}
+			${_OUTPUT_PATH_2}
+			${GRACO_SHARD_OUTPUT_LIST}
+		MAIN_DEPENDENCY ${_INPUT_PATH}
+		COMMAND ${GRACO_EXE}
+			${_INPUT_PATH}
+			-o${_OUTPUT_PATH_1}
+			-o${_OUTPUT_PATH_2}
+			-f${_FRAME_PATH_1}
+			-f${_FRAME_PATH_2}
+			${_SHARD_ARG_LIST}
+		DEPENDS
+			${_FRAME_PATH_1}
+			${_FRAME_PATH_2}
+			${_DEPENDENCY_LIST}
+		)
+endmacro()
+
 #...............................................................................
@@ -34,6 +34,7 @@ end
 -- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 
 TokenCount      = #TokenTable
+TokenClassCount = #TokenClassRepresentativeTable
 SymbolCount     = #SymbolTable
 EnterCount      = #EnterTable
 LeaveCount      = #LeaveTable
@@ -53,6 +54,15 @@ ArgumentEnd     = ActionEnd + ArgumentCount
 BeaconEnd       = ArgumentEnd + BeaconCount
 LaDfaEnd        = BeaconEnd + LaDfaCount
 
+if PragmaStartSymbol ~= -1 then
+	PragmaStartRow = ParseTable[PragmaStartSymbol + 1]
+end
+
+-- a frame passed more than once is sharded: shard 0 gets the tables and the
+-- dispatchers, the generated functions are distributed by the ShardTable
+
+Shard = ShardTable[ShardIndex + 1]
+
 -------------------------------------------------------------------------------
 
 function getPpLine(filePath, line)
@@ -84,6 +94,20 @@ function getTokenString(token)
 	end
 end
 
+-- i is a 1-based index into TokenTable
+
+function getTokenInfoString(i)
+	local flags = "0"
+	if PragmaStartRow then
+		local production = PragmaStartRow[i]
+		if production ~= -1 and production ~= 0 then
+			flags = "llk::TokenInfoFlag_PragmaStart"
+		end
+	end
+
+	return string.format("llk::TokenInfo(%d, %d, %s)", i - 1, TokenClassTable[i], flags)
+end
+
 function getSymbolDeclaration(symbol, name, value)
 	if symbol.isCustomClass then
 		return string.format("SymbolNode_%s* %s = (SymbolNode_%s*)%s;", symbol.name, name, symbol.name, value)
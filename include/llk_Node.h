@@ -15,6 +15,8 @@
 
 #include "llk_Pch.h"
 
+// #define _LLK_ALLOC_STATS 1 // count run-time allocations (steady-state tests)
+
 namespace llk {
 
 // these are run-time nodes (as opposed to compile-time nodes in src/Node.h)
@@ -104,6 +106,20 @@ class NodeAllocatorBase: public axl::rc::RefCount {
 protected:
 	NodeList m_freeList;
 
+#if (_LLK_ALLOC_STATS)
+	size_t m_allocCount; // free list misses
+
+public:
+	NodeAllocatorBase() {
+		m_allocCount = 0;
+	}
+
+	size_t
+	getAllocCount() {
+		return m_allocCount;
+	}
+#endif
+
 public:
 	void
 	free(Node* node) {
@@ -140,12 +156,27 @@ public:
 	allocate() {
 		ASSERT(sizeof(N) <= MaxNodeSize);
 
+#if (_LLK_ALLOC_STATS)
+		if (m_freeList.isEmpty())
+			m_allocCount++;
+#endif
+
 		Node* node = !m_freeList.isEmpty() ?
 			m_freeList.removeHead() :
 			(Node*)axl::mem::allocate(MaxNodeSize);
 
 		return new (node) N;
 	}
+
+	void
+	reserve(size_t count) {
+		for (size_t i = m_freeList.getCount(); i < count; i++) {
+#if (_LLK_ALLOC_STATS)
+			m_allocCount++;
+#endif
+			m_freeList.insertHead((Node*)axl::mem::allocate(MaxNodeSize));
+		}
+	}
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -27,6 +27,36 @@ namespace llk {
 
 //..............................................................................
 
+enum TokenInfoFlag {
+	TokenInfoFlag_PragmaStart = 0x01, // out-of-band pragma production starts here
+};
+
+// everything the parser needs per token is fetched with a single token map lookup
+
+struct TokenInfo {
+	size_t m_index;
+	size_t m_class; // tokens with identical parse table columns share a class
+	uint_t m_flags;
+
+	TokenInfo() {
+		m_index = -1;
+		m_class = -1;
+		m_flags = 0;
+	}
+
+	TokenInfo(
+		size_t index,
+		size_t tokenClass,
+		uint_t flags = 0
+	) {
+		m_index = index;
+		m_class = tokenClass;
+		m_flags = flags;
+	}
+};
+
+//..............................................................................
+
 template <
 	typename T,
 	typename Token0
@@ -81,6 +111,22 @@ protected:
 		size_t m_resolverElseIndex;
 	};
 
+#if (_LLK_ALLOC_STATS)
+public:
+	// real heap allocations made by the parser itself (the node allocator and
+	// the token pool are counted separately)
+
+	struct AllocStats {
+		size_t m_tokenCount;      // tokens currently owned by the parser
+		size_t m_stackAllocCount; // stack buffer (re)allocations
+		size_t m_syncAllocCount;  // sync token set entries
+
+		AllocStats() {
+			memset(this, 0, sizeof(AllocStats));
+		}
+	};
+#endif
+
 protected:
 	axl::sl::StringRef m_fileName;
 
@@ -96,6 +142,10 @@ protected:
 	axl::sl::Iterator<Token> m_tokenCursor;
 	uint_t m_flags;
 
+#if (_LLK_ALLOC_STATS)
+	AllocStats m_allocStats;
+#endif
+
 public:
 	Parser() {
 		// the same parser is normally never shared among threads
@@ -128,12 +178,40 @@ public:
 	) {
 		clear();
 		m_fileName = fileName;
+		reserve(symbol);
 		return (SymbolNode*)pushPrediction(T::SymbolFirst + symbol);
 	}
 
+	// pre-allocate stacks (and prediction nodes) so that parsing doesn't stall on growth
+
+	void
+	reserve(
+		size_t predictionStackSize,
+		size_t symbolStackSize,
+		size_t catchStackSize = 0,
+		size_t resolverStackSize = 0
+	) {
+		reserveStack(&m_predictionStack, predictionStackSize);
+		reserveStack(&m_symbolStack, symbolStackSize);
+		reserveStack(&m_catchStack, catchStackSize);
+		reserveStack(&m_resolverStack, resolverStackSize);
+		m_nodeAllocator->reserve(predictionStackSize);
+	}
+
+	void
+	reserve(int symbol = T::StartSymbol) {
+		const size_t* depth = static_cast<T*>(this)->getStackDepthHint(symbol); // calculated by graco
+		reserve(depth[0], depth[1], depth[2], depth[3]);
+	}
+
 	void
 	clear() {
 		m_fileName.clear();
+
+#if (_LLK_ALLOC_STATS)
+		m_allocStats.m_tokenCount -= m_tokenList.getCount();
+#endif
+
 		m_tokenPool->put(&m_tokenList);
 
 		size_t count = m_predictionStack.getCount();
@@ -166,24 +244,35 @@ public:
 	}
 #endif
 
+#if (_LLK_ALLOC_STATS)
+	const AllocStats&
+	getAllocStats() const {
+		return m_allocStats;
+	}
+#endif
+
 	bool
 	consumeToken(Token* token) {
 		bool result;
 
+#if (_LLK_ALLOC_STATS)
+		m_allocStats.m_tokenCount++;
+#endif
+
 		if (token->m_token == -1) {
 			axl::err::setFormatStringError("invalid character '\\x%x'", token->m_data.m_integer);
 			axl::lex::ensureSrcPosError(m_fileName, token->m_pos);
-			m_tokenPool->put(token);
+			putToken(token);
 			return false;
 		}
 
 		if (m_flags & Flag_Synchronize) {
 			MatchResult matchResult = synchronize(token);
 			if (matchResult == MatchResult_NextToken) {
-				m_tokenPool->put(token);
+				putToken(token);
 				return true;
 			} else if (matchResult == MatchResult_Fail) {
-				m_tokenPool->put(token);
+				putToken(token);
 				axl::lex::ensureSrcPosError(m_fileName, token->m_pos);
 				return false;
 			}
@@ -192,13 +281,13 @@ public:
 		m_tokenCursor = m_tokenList.insertTail(token);
 
 		const size_t* parseTable = static_cast<T*>(this)->getParseTable();
-		size_t tokenIndex = static_cast<T*>(this)->getTokenIndex(token->m_token);
-		ASSERT(tokenIndex < T::TokenCount);
+		TokenInfo tokenInfo = static_cast<T*>(this)->getTokenInfo(token->m_token);
+		ASSERT(tokenInfo.m_index < T::TokenCount);
 
-		// first check for pragma productions out of band
+		// first check for pragma productions out of band (one flag test for the common case)
 
-		if (T::PragmaStartSymbol != -1) {
-			size_t productionIndex = parseTable[T::PragmaStartSymbol * T::TokenCount + tokenIndex];
+		if (T::PragmaStartSymbol != -1 && (tokenInfo.m_flags & TokenInfoFlag_PragmaStart)) {
+			size_t productionIndex = parseTable[T::PragmaStartSymbol * T::getTokenClassCount() + tokenInfo.m_class];
 			if (productionIndex != -1 && productionIndex != 0)
 				pushPrediction(productionIndex);
 		}
@@ -220,8 +309,8 @@ public:
 					// fall through
 
 				case MatchResult_NextTokenNoAdvance:
-					tokenIndex = static_cast<T*>(this)->getTokenIndex(m_tokenCursor->m_token);
-					ASSERT(tokenIndex < T::TokenCount);
+					tokenInfo = static_cast<T*>(this)->getTokenInfo(m_tokenCursor->m_token);
+					ASSERT(tokenInfo.m_index < T::TokenCount);
 					m_flags &= ~Flag_TokenMatch;
 					break;
 
@@ -238,11 +327,11 @@ public:
 			} else {
 				switch (node->m_nodeKind) {
 				case NodeKind_Token:
-					matchResult = matchTokenNode((TokenNode*)node, tokenIndex);
+					matchResult = matchTokenNode((TokenNode*)node, tokenInfo.m_index);
 					break;
 
 				case NodeKind_Symbol:
-					matchResult = matchSymbolNode((SymbolNode*)node, parseTable, tokenIndex);
+					matchResult = matchSymbolNode((SymbolNode*)node, parseTable, tokenInfo.m_class);
 					break;
 
 				case NodeKind_Sequence:
@@ -292,8 +381,8 @@ public:
 				// fall through
 
 			case MatchResult_NextTokenNoAdvance:
-				tokenIndex = static_cast<T*>(this)->getTokenIndex(m_tokenCursor->m_token);
-				ASSERT(tokenIndex < T::TokenCount);
+				tokenInfo = static_cast<T*>(this)->getTokenInfo(m_tokenCursor->m_token);
+				ASSERT(tokenInfo.m_index < T::TokenCount);
 				m_flags &= ~Flag_TokenMatch;
 				break;
 
@@ -433,6 +522,10 @@ protected:
 				m_syncTokenSet.addIfNotExists(*p, i);
 		}
 
+#if (_LLK_ALLOC_STATS)
+		m_allocStats.m_syncAllocCount += m_syncTokenSet.getCount(); // one node per entry
+#endif
+
 		if (m_syncTokenSet.isEmpty()) {
 			if (m_flags & Flag_RecoveryFailureErrors) {
 				axl::err::setError("unable to recover from previous error(s)");
@@ -444,6 +537,10 @@ protected:
 
 		// reset and wait for a synchornization token
 
+#if (_LLK_ALLOC_STATS)
+		m_allocStats.m_tokenCount -= m_tokenList.getCount() - 1; // all but the cursor go
+#endif
+
 		m_tokenList.clearButEntry(m_tokenCursor);
 		m_flags |= Flag_Synchronize;
 		return RecoveryAction_Synchronize;
@@ -520,13 +617,53 @@ protected:
 	}
 #endif
 
+	void
+	putToken(Token* token) {
+#if (_LLK_ALLOC_STATS)
+		m_allocStats.m_tokenCount--;
+#endif
+		m_tokenPool->put(token);
+	}
+
+	template <typename E>
+	void
+	reserveStack(
+		axl::sl::Array<E>* stack,
+		size_t count
+	) {
+#if (_LLK_ALLOC_STATS)
+		const E* p = stack->cp();
+		stack->reserve(count);
+		if (stack->cp() != p)
+			m_allocStats.m_stackAllocCount++;
+#else
+		stack->reserve(count);
+#endif
+	}
+
+	template <typename E>
+	void
+	pushStack(
+		axl::sl::Array<E>* stack,
+		E e
+	) {
+#if (_LLK_ALLOC_STATS)
+		const E* p = stack->cp();
+		stack->append(e);
+		if (stack->cp() != p) // the buffer had to grow
+			m_allocStats.m_stackAllocCount++;
+#else
+		stack->append(e);
+#endif
+	}
+
 	bool
 	advanceTokenCursor() {
 		m_tokenCursor++;
 
 		Node* node = getPredictionTop();
 		if (m_resolverStack.isEmpty() && (!node || node->m_nodeKind != NodeKind_LaDfa)) {
-			m_tokenPool->put(m_tokenList.removeHead()); // nobody gonna reparse this token
+			putToken(m_tokenList.removeHead()); // nobody gonna reparse this token
 			ASSERT(m_tokenCursor == m_tokenList.getHead());
 		}
 
@@ -584,7 +721,7 @@ protected:
 	matchSymbolNode(
 		SymbolNode* node,
 		const size_t* parseTable,
-		size_t tokenIndex
+		size_t tokenClass
 	) {
 		bool result;
 
@@ -663,7 +800,7 @@ protected:
 			return recover(ErrorKind_Syntax) ? MatchResult_Continue : MatchResult_Fail;
 #endif
 
-		size_t productionIndex = parseTable[node->m_index * T::TokenCount + tokenIndex];
+		size_t productionIndex = parseTable[node->m_index * T::getTokenClassCount() + tokenClass];
 		if (productionIndex == -1) {
 			if (!m_resolverStack.isEmpty())
 				return MatchResult_Fail; // rollback resolver
@@ -932,7 +1069,7 @@ protected:
 			return NULL;
 
 		Node* node = createNode(masterIndex);
-		m_predictionStack.append(node);
+		pushStack(&m_predictionStack, node);
 		return node;
 	}
 
@@ -950,7 +1087,7 @@ protected:
 	void
 	pushSymbol(SymbolNode* node) {
 		ASSERT(isNamedSymbol(node));
-		m_symbolStack.append(node);
+		pushStack(&m_symbolStack, node);
 		node->m_flags |= SymbolNodeFlag_Stacked;
 	}
 
@@ -966,7 +1103,7 @@ protected:
 	void
 	pushCatch(SymbolNode* node) {
 		ASSERT(isCatchSymbol(node));
-		m_catchStack.append(node);
+		pushStack(&m_catchStack, node);
 		node->m_catchSymbolCount = m_symbolStack.getCount();
 		node->m_flags |= SymbolNodeFlag_Stacked;
 	}
@@ -988,7 +1125,7 @@ protected:
 
 	void
 	pushPreResolver(LaDfaNode* node) {
-		m_resolverStack.append(node);
+		pushStack(&m_resolverStack, node);
 		node->m_flags |= LaDfaNodeFlag_PreResolver;
 	}
 
@@ -1030,19 +1167,44 @@ protected:
 		return node && node->m_nodeKind == NodeKind_Symbol ? ((SymbolNode*)node)->getValue() : NULL;
 	}
 
+	// may be shadowed in derived class; parsers generated without token classes
+	// only provide getTokenIndex() -- then each token is a class of its own and
+	// every token is checked for a pragma production; without stack depth hints,
+	// stacks simply grow on demand
+
+	static
+	size_t
+	getTokenClassCount() {
+		return T::TokenCount;
+	}
+
+	static
+	TokenInfo
+	getTokenInfo(int token) {
+		size_t index = T::getTokenIndex(token);
+		return TokenInfo(index, index, T::PragmaStartSymbol != -1 ? TokenInfoFlag_PragmaStart : 0);
+	}
+
+	static
+	const size_t*
+	getStackDepthHint(size_t index) { // no hint: reserve(symbol) pre-allocates nothing
+		static const size_t depth[4] = { 0 };
+		return depth;
+	}
+
 	// must be implemented in derived class:
 
 	// static
 	// const size_t*
-	// getParseTable();
+	// getParseTable(); // columns are token classes
 
 	// static
 	// const size_t*
 	// getSequence(size_t index);
 
 	// static
-	// size_t
-	// getTokenIndex(int token);
+	// TokenInfo
+	// getTokenInfo(int token); // unknown tokens map to AnyToken (or getTokenIndex, see above)
 
 	// static
 	// int
@@ -1052,6 +1214,10 @@ protected:
 	// const char*
 	// getSymbolName(size_t index);
 
+	// static
+	// const size_t*
+	// getStackDepthHint(size_t index); // prediction, symbol, catch, resolver (optional, see above)
+
 	// static
 	// SymbolNode*
 	// createSymbolNode(size_t index); // allocate node with llk::NodeAllocator
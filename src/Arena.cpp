@@ -0,0 +1,82 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "Arena.h"
+
+//..............................................................................
+
+void
+Arena::reset() {
+	size_t count = m_extraBlockArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		delete[] m_extraBlockArray[i];
+
+	m_extraBlockArray.clear();
+	m_blockIdx = 0;
+	m_offset = 0;
+}
+
+void
+Arena::clear() {
+	reset();
+
+	size_t count = m_blockArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		delete[] m_blockArray[i].m_p;
+
+	m_blockArray.clear();
+}
+
+void*
+Arena::allocate(size_t size) {
+	size = (size + Alignment - 1) & ~(Alignment - 1);
+
+	if (size > MaxBlockSize / 4) { // don't waste the rest of the current block
+		char* p = new char[size];
+		m_extraBlockArray.append(p);
+		return p;
+	}
+
+	size_t count = m_blockArray.getCount();
+	while (m_blockIdx < count && m_offset + size > m_blockArray[m_blockIdx].m_size) {
+		m_blockIdx++;
+		m_offset = 0;
+	}
+
+	if (m_blockIdx >= count) {
+		size_t blockSize = count ? AXL_MIN(m_blockArray.getBack().m_size * 2, MaxBlockSize) : MinBlockSize;
+		if (blockSize < size)
+			blockSize = size;
+
+		Block block = { new char[blockSize], blockSize };
+		m_blockArray.append(block);
+	}
+
+	char* p = m_blockArray[m_blockIdx].m_p + m_offset;
+	m_offset += size;
+	return p;
+}
+
+void
+Arena::takeOver(Arena* arena) {
+	size_t count = arena->m_blockArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		m_extraBlockArray.append(arena->m_blockArray[i].m_p);
+
+	m_extraBlockArray.append(arena->m_extraBlockArray.cp(), arena->m_extraBlockArray.getCount());
+	arena->m_blockArray.clear();
+	arena->m_extraBlockArray.clear();
+	arena->m_blockIdx = 0;
+	arena->m_offset = 0;
+}
+
+//..............................................................................
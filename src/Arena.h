@@ -0,0 +1,91 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// bump allocator: objects are never freed one by one -- all the memory goes at
+// once on reset or destruction (running destructors is up to the owner).
+// Blocks start small and double up to MaxBlockSize, so the many arenas holding
+// just a few objects (e.g. the DFA of a single conflict) stay small
+
+class Arena {
+protected:
+	enum {
+		MinBlockSize = 1024,
+		MaxBlockSize = 64 * 1024,
+		Alignment    = 16,
+	};
+
+	struct Block {
+		char* m_p;
+		size_t m_size;
+	};
+
+protected:
+	sl::Array<Block> m_blockArray;
+	sl::Array<char*> m_extraBlockArray; // oversized allocations & blocks of other arenas
+	size_t m_blockIdx;
+	size_t m_offset;
+
+public:
+	Arena() {
+		m_blockIdx = 0;
+		m_offset = 0;
+	}
+
+	~Arena() {
+		clear();
+	}
+
+	void
+	reset(); // keeps the blocks for the next run
+
+	void
+	clear();
+
+	void*
+	allocate(size_t size);
+
+	void
+	takeOver(Arena* arena); // the other arena becomes empty
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// objects which can only be allocated in an arena; lists still "delete" them,
+// but that only runs the destructor
+
+class ArenaObject {
+public:
+	static
+	void*
+	operator new(
+		size_t size,
+		Arena* arena
+	) {
+		return arena->allocate(size);
+	}
+
+	static
+	void
+	operator delete(
+		void* p,
+		Arena* arena
+	) {} // only called if a constructor throws
+
+	static
+	void
+	operator delete(void* p) {}
+};
+
+//..............................................................................
@@ -0,0 +1,100 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// dense bit matrix with word-aligned rows -- rows are merged a machine word at a time
+
+class BitMatrix {
+protected:
+	enum {
+		WordBitCount = sizeof(size_t) * 8,
+	};
+
+protected:
+	sl::Array<size_t> m_buffer;
+	size_t m_rowCount;
+	size_t m_columnCount;
+	size_t m_rowWordCount;
+
+public:
+	BitMatrix() {
+		m_rowCount = 0;
+		m_columnCount = 0;
+		m_rowWordCount = 0;
+	}
+
+	void
+	create(
+		size_t rowCount,
+		size_t columnCount
+	) {
+		m_rowCount = rowCount;
+		m_columnCount = columnCount;
+		m_rowWordCount = (columnCount + WordBitCount - 1) / WordBitCount;
+		m_buffer.clear();
+		m_buffer.setCountZeroConstruct(rowCount * m_rowWordCount);
+	}
+
+	const size_t*
+	getRow(size_t row) {
+		ASSERT(row < m_rowCount);
+		return m_buffer.cp() + row * m_rowWordCount;
+	}
+
+	bool
+	getBit(
+		size_t row,
+		size_t column
+	) {
+		ASSERT(column < m_columnCount);
+		return (getRow(row)[column / WordBitCount] & ((size_t)1 << (column % WordBitCount))) != 0;
+	}
+
+	void
+	setBit(
+		size_t row,
+		size_t column
+	) {
+		ASSERT(row < m_rowCount && column < m_columnCount);
+		m_buffer.p()[row * m_rowWordCount + column / WordBitCount] |= (size_t)1 << (column % WordBitCount);
+	}
+
+	// Warshall: columns [firstColumn, firstColumn + rowCount) stand for the rows
+	// themselves; all the other columns are sinks and ride along with the rows
+
+	void
+	calcTransitiveClosure(size_t firstColumn) {
+		ASSERT(firstColumn + m_rowCount <= m_columnCount);
+
+		size_t* p = m_buffer.p();
+
+		for (size_t k = 0; k < m_rowCount; k++) {
+			size_t column = firstColumn + k;
+			size_t wordIdx = column / WordBitCount;
+			size_t mask = (size_t)1 << (column % WordBitCount);
+			const size_t* src = p + k * m_rowWordCount;
+
+			for (size_t i = 0; i < m_rowCount; i++) {
+				size_t* dst = p + i * m_rowWordCount;
+				if (i == k || !(dst[wordIdx] & mask))
+					continue;
+
+				for (size_t j = 0; j < m_rowWordCount; j++)
+					dst[j] |= src[j];
+			}
+		}
+	}
+};
+
+//..............................................................................
@@ -18,6 +18,14 @@ CmdLine::CmdLine() {
 	m_flags = 0;
 	m_lookaheadLimit = 1;
 	m_conflictDepthLimit = 4;
+	m_laDfaStateLimit = 4096;
+	m_laDfaThreadLimit = 65536;
+	m_autoLookaheadLimit = 0;
+	m_jobCount = 0;
+	m_sentenceSize = 1024;
+	m_sentenceCount = 1;
+	m_sentenceDepthLimit = 64;
+	m_sentenceSeed = 1;
 }
 
 //..............................................................................
@@ -46,6 +54,10 @@ CmdLineParser::onSwitch(
 		m_cmdLine->m_flags |= CmdLineFlag_NoPpLine;
 		break;
 
+	case CmdLineSwitchKind_NoUserCode:
+		m_cmdLine->m_flags |= CmdLineFlag_NoUserCode;
+		break;
+
 	case CmdLineSwitchKind_Verbose:
 		m_cmdLine->m_flags |= CmdLineFlag_Verbose;
 		break;
@@ -54,10 +66,46 @@ CmdLineParser::onSwitch(
 		m_cmdLine->m_lookaheadLimit = atoi(value.sz());
 		break;
 
+	case CmdLineSwitchKind_AutoLookahead:
+		m_cmdLine->m_autoLookaheadLimit = atoi(value.sz());
+		break;
+
 	case CmdLineSwitchKind_ConflictDepthLimit:
 		m_cmdLine->m_conflictDepthLimit = atoi(value.sz());
 		break;
 
+	case CmdLineSwitchKind_LlStar:
+		m_cmdLine->m_flags |= CmdLineFlag_LlStar;
+		break;
+
+	case CmdLineSwitchKind_LaDfaStateLimit:
+		m_cmdLine->m_laDfaStateLimit = atoi(value.sz());
+		break;
+
+	case CmdLineSwitchKind_LaDfaThreadLimit:
+		m_cmdLine->m_laDfaThreadLimit = atoi(value.sz());
+		break;
+
+	case CmdLineSwitchKind_NoResolverDfa:
+		m_cmdLine->m_flags |= CmdLineFlag_NoResolverDfa;
+		break;
+
+	case CmdLineSwitchKind_JobCount:
+		m_cmdLine->m_jobCount = atoi(value.sz());
+		break;
+
+	case CmdLineSwitchKind_ClosureGrammarProps:
+		m_cmdLine->m_flags |= CmdLineFlag_ClosureGrammarProps;
+		break;
+
+	case CmdLineSwitchKind_NoNodeSharing:
+		m_cmdLine->m_flags |= CmdLineFlag_NoNodeSharing;
+		break;
+
+	case CmdLineSwitchKind_NoInlining:
+		m_cmdLine->m_flags |= CmdLineFlag_NoInlining;
+		break;
+
 	case CmdLineSwitchKind_OutputFileName:
 		m_cmdLine->m_outputFileNameList.insertTail(value);
 		break;
@@ -66,10 +114,18 @@ CmdLineParser::onSwitch(
 		m_cmdLine->m_frameFileNameList.insertTail(value);
 		break;
 
+	case CmdLineSwitchKind_NativeCpp:
+		m_cmdLine->m_flags |= CmdLineFlag_NativeCpp;
+		break;
+
 	case CmdLineSwitchKind_BnfFileName:
 		m_cmdLine->m_bnfFileName = value;
 		break;
 
+	case CmdLineSwitchKind_LookaheadReportFileName:
+		m_cmdLine->m_lookaheadReportFileName = value;
+		break;
+
 	case CmdLineSwitchKind_GracoBnf:
 		m_cmdLine->m_flags |= CmdLineFlag_GracoBnf;
 		break;
@@ -78,6 +134,30 @@ CmdLineParser::onSwitch(
 		m_cmdLine->m_traceFileName = value;
 		break;
 
+	case CmdLineSwitchKind_SentenceFileName:
+		m_cmdLine->m_sentenceFileName = value;
+		break;
+
+	case CmdLineSwitchKind_SpellingFileName:
+		m_cmdLine->m_spellingFileName = value;
+		break;
+
+	case CmdLineSwitchKind_SentenceSize:
+		m_cmdLine->m_sentenceSize = atoi(value.sz());
+		break;
+
+	case CmdLineSwitchKind_SentenceCount:
+		m_cmdLine->m_sentenceCount = atoi(value.sz());
+		break;
+
+	case CmdLineSwitchKind_SentenceDepthLimit:
+		m_cmdLine->m_sentenceDepthLimit = atoi(value.sz());
+		break;
+
+	case CmdLineSwitchKind_SentenceSeed:
+		m_cmdLine->m_sentenceSeed = atoi(value.sz());
+		break;
+
 	case CmdLineSwitchKind_OutputDir:
 		m_cmdLine->m_outputDir = value;
 		break;
@@ -105,6 +185,16 @@ CmdLineParser::finalize() {
 		return false;
 	}
 
+	if (!m_cmdLine->m_sentenceDepthLimit) {
+		err::setError("sentence depth limit must be positive");
+		return false;
+	}
+
+	if (!m_cmdLine->m_sentenceCount) {
+		err::setError("sentence count must be positive");
+		return false;
+	}
+
 	return true;
 }
 
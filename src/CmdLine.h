@@ -19,6 +19,13 @@ enum CmdLineFlag {
 	CmdLineFlag_Verbose  = 0x04,
 	CmdLineFlag_NoPpLine = 0x08,
 	CmdLineFlag_GracoBnf = 0x10,
+	CmdLineFlag_NoUserCode = 0x20,
+	CmdLineFlag_ClosureGrammarProps = 0x40,
+	CmdLineFlag_NoNodeSharing = 0x80,
+	CmdLineFlag_NoInlining = 0x100,
+	CmdLineFlag_LlStar = 0x200,
+	CmdLineFlag_NoResolverDfa = 0x400,
+	CmdLineFlag_NativeCpp = 0x800,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -27,11 +34,22 @@ struct CmdLine {
 	uint_t m_flags;
 	size_t m_lookaheadLimit;
 	size_t m_conflictDepthLimit;
+	size_t m_laDfaStateLimit;
+	size_t m_laDfaThreadLimit;
+	size_t m_autoLookaheadLimit;
+	size_t m_jobCount;
 	sl::String m_inputFileName;
 	sl::BoxList<sl::String> m_outputFileNameList;
 	sl::BoxList<sl::String> m_frameFileNameList;
 	sl::String m_bnfFileName;
+	sl::String m_lookaheadReportFileName;
 	sl::String m_traceFileName;
+	sl::String m_sentenceFileName;
+	sl::String m_spellingFileName;
+	size_t m_sentenceSize;
+	size_t m_sentenceCount;
+	size_t m_sentenceDepthLimit;
+	uint_t m_sentenceSeed;
 
 	sl::String m_outputDir;
 	sl::BoxList<sl::String> m_frameDirList;
@@ -48,16 +66,34 @@ enum CmdLineSwitchKind {
 	CmdLineSwitchKind_Version,
 	CmdLineSwitchKind_NoPpLine,
 	CmdLineSwitchKind_LookaheadLimit,
+	CmdLineSwitchKind_AutoLookahead,
 	CmdLineSwitchKind_ConflictDepthLimit,
+	CmdLineSwitchKind_LlStar,
+	CmdLineSwitchKind_LaDfaStateLimit,
+	CmdLineSwitchKind_LaDfaThreadLimit,
+	CmdLineSwitchKind_NoResolverDfa,
+	CmdLineSwitchKind_JobCount,
+	CmdLineSwitchKind_ClosureGrammarProps,
+	CmdLineSwitchKind_NoNodeSharing,
+	CmdLineSwitchKind_NoInlining,
 	CmdLineSwitchKind_Verbose,
 	CmdLineSwitchKind_OutputFileName,
 	CmdLineSwitchKind_FrameFileName,
+	CmdLineSwitchKind_NativeCpp,
 	CmdLineSwitchKind_BnfFileName,
+	CmdLineSwitchKind_LookaheadReportFileName,
 	CmdLineSwitchKind_TraceFileName,
 	CmdLineSwitchKind_OutputDir,
 	CmdLineSwitchKind_FrameDir,
 	CmdLineSwitchKind_ImportDir,
 	CmdLineSwitchKind_GracoBnf,
+	CmdLineSwitchKind_NoUserCode,
+	CmdLineSwitchKind_SentenceFileName,
+	CmdLineSwitchKind_SpellingFileName,
+	CmdLineSwitchKind_SentenceSize,
+	CmdLineSwitchKind_SentenceCount,
+	CmdLineSwitchKind_SentenceDepthLimit,
+	CmdLineSwitchKind_SentenceSeed,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -81,18 +117,78 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"Suppress #line preprocessor directives"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_NoUserCode,
+		"no-user-code", NULL,
+		"Discard actions, arguments and user code blocks (for testing grammars)"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH(
 		CmdLineSwitchKind_LookaheadLimit,
 		"lookahead-limit", "<limit>",
 		"Specify number of tokens used for conflict resolution (defaults to 2)"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_AutoLookahead,
+		"auto-lookahead", "<limit>",
+		"Ignore lookahead annotations; give each conflict as many tokens as it needs, up to <limit>"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH(
 		CmdLineSwitchKind_ConflictDepthLimit,
 		"conflict-depth-limit", "<limit>",
 		"Limit the depth of nested conflicts (defaults to 2)"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_LlStar,
+		"ll-star", NULL,
+		"Build cyclic lookahead DFAs for conflicts (LL(*), ignores lookahead limits)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_LaDfaStateLimit,
+		"ladfa-state-limit", "<limit>",
+		"Limit the number of lookahead DFA states per conflict (defaults to 4096)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_LaDfaThreadLimit,
+		"ladfa-thread-limit", "<limit>",
+		"Limit the number of lookahead DFA threads per conflict (defaults to 65536)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_NoResolverDfa,
+		"no-resolver-dfa", NULL,
+		"Don't compile regular resolvers into lookahead DFAs (always try them at runtime)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_JobCount,
+		"j", "jobs", "<count>",
+		"Specify number of worker threads (defaults to the number of CPUs)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_ClosureGrammarProps,
+		"closure-first-follow", NULL,
+		"Calculate FIRST/FOLLOW sets with bit-matrix closures (for large grammars)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_NoNodeSharing,
+		"no-node-sharing", NULL,
+		"Don't merge identical quantifiers, groups and sequences"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_NoInlining,
+		"no-inlining", NULL,
+		"Don't inline pass-through symbols into their callers"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH_2(
 		CmdLineSwitchKind_Verbose,
 		"z", "verbose", NULL,
@@ -113,6 +209,12 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"Specify Lua frame file (multiple allowed)"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_NativeCpp,
+		"native-cpp", NULL,
+		"Generate output of the bundled (marked) CppParser.h.in/CppParser.cpp.in natively (without Lua)"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH_2(
 		CmdLineSwitchKind_BnfFileName,
 		"b", "bnf", "<file>",
@@ -125,12 +227,56 @@ AXL_SL_BEGIN_CMD_LINE_SWITCH_TABLE(CmdLineSwitchTable, CmdLineSwitchKind)
 		"Use the Graco EBNF dialect"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_LookaheadReportFileName,
+		"lookahead-report", "<file>",
+		"Write lookahead used by each conflict and over-provisioned annotations"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH_2(
 		CmdLineSwitchKind_TraceFileName,
 		"t", "trace", "<file>",
 		"Write verbose information into trace file"
 	)
 
+	AXL_SL_CMD_LINE_SWITCH_GROUP("Sentence generation")
+
+	AXL_SL_CMD_LINE_SWITCH_2(
+		CmdLineSwitchKind_SentenceFileName,
+		"s", "sentence", "<file>",
+		"Generate a random sentence of the grammar (token stream)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_SpellingFileName,
+		"spelling", "<file>",
+		"Specify token spelling map (generate text instead of token stream)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_SentenceSize,
+		"sentence-size", "<count>",
+		"Specify approximate number of tokens in the sentence (defaults to 1024)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_SentenceCount,
+		"sentence-count", "<count>",
+		"Specify number of sentences in the output file (defaults to 1)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_SentenceDepthLimit,
+		"sentence-depth", "<limit>",
+		"Limit the symbol nesting depth of the sentence (defaults to 64)"
+	)
+
+	AXL_SL_CMD_LINE_SWITCH(
+		CmdLineSwitchKind_SentenceSeed,
+		"sentence-seed", "<seed>",
+		"Specify random seed for the sentence (defaults to 1)"
+	)
+
 	AXL_SL_CMD_LINE_SWITCH_GROUP("Directories")
 
 	AXL_SL_CMD_LINE_SWITCH_2(
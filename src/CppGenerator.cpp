@@ -0,0 +1,1431 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "CppGenerator.h"
+#include "Module.h"
+
+//..............................................................................
+
+static const char SeparatorLine[] =
+	"//..............................................................................\n";
+
+static const char SubSeparatorLine[] =
+	"// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .\n";
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+CppGenerator::CppGenerator(const CmdLine* cmdLine) {
+	m_cmdLine = cmdLine;
+	m_module = NULL;
+	m_nodeMgr = NULL;
+	m_buffer = NULL;
+	m_shardIndex = 0;
+	m_line = 0;
+	m_lineOffset = 0;
+	m_ppLineFormat = NULL;
+	m_namedSymbolCount = 0;
+	m_catchSymbolCount = 0;
+	m_laDfaCount = 0;
+}
+
+// the bundled frames are marked with a line naming the frame and the revision
+// of the frames this generator reproduces; modified copies must drop it, so
+// they go through Lua. Bump the revision whenever the frames and the generator
+// change together
+
+CppFrameKind
+CppGenerator::getFrameKind(const sl::StringRef& frame) {
+	static const struct {
+		const char* m_marker;
+		CppFrameKind m_frameKind;
+	} markerTable[] = {
+		{ "-- graco-native-cpp: CppParser.h.in r2", CppFrameKind_Header },
+		{ "-- graco-native-cpp: CppParser.cpp.in r2", CppFrameKind_Source },
+	};
+
+	enum {
+		ScanSize = 1024, // the marker is in the opening Lua block
+	};
+
+	const char* p = frame.cp();
+	const char* end = p + AXL_MIN(frame.getLength(), ScanSize);
+
+	while (p < end) {
+		const char* eol = (const char*)memchr(p, '\n', end - p);
+		if (!eol)
+			break;
+
+		size_t length = eol > p && eol[-1] == '\r' ? eol - p - 1 : eol - p;
+		for (size_t i = 0; i < countof(markerTable); i++)
+			if (length == strlen(markerTable[i].m_marker) && memcmp(p, markerTable[i].m_marker, length) == 0)
+				return markerTable[i].m_frameKind;
+
+		p = eol + 1;
+	}
+
+	return CppFrameKind_None;
+}
+
+bool
+CppGenerator::generate(
+	sl::String* buffer,
+	Module* module,
+	const sl::StringRef& targetFilePath,
+	CppFrameKind frameKind,
+	size_t shardIndex
+) {
+	m_buffer = buffer;
+	m_buffer->clear();
+	m_shardIndex = shardIndex;
+	m_line = 0;
+	m_lineOffset = 0;
+
+	// TargetFilePath is only used in #line directives, so back-slashes can go now
+
+	m_targetFilePath = targetFilePath;
+	char* p = m_targetFilePath.getBuffer();
+	size_t length = m_targetFilePath.getLength();
+	for (size_t i = 0; i < length; i++)
+		if (p[i] == '\\')
+			p[i] = '/';
+
+	prepare(module);
+
+	switch (frameKind) {
+	case CppFrameKind_Header:
+		return generateHeader();
+
+	case CppFrameKind_Source:
+		return generateSource();
+
+	default:
+		ASSERT(false);
+		return false;
+	}
+}
+
+void
+CppGenerator::prepare(Module* module) {
+	m_module = module;
+	m_nodeMgr = &module->m_nodeMgr;
+
+	m_parserClassName = getDefineString("ParserClassName", "Parser");
+	m_tokenClassName = getDefineString("TokenClassName", "Token");
+	m_symbolVariableName = getDefineString("SymbolVariableName", "__symbol");
+	m_targetVariableName = getDefineString("TargetVariableName", "__target");
+
+	m_ppLineFormat = isDefineTrue("NoPpLine", (m_cmdLine->m_flags & CmdLineFlag_NoPpLine) != 0) ?
+		"// #line %d \"%s\"" :
+		"#line %d \"%s\"";
+
+	m_namedSymbolCount = m_nodeMgr->m_namedSymbolList.getCount();
+	m_catchSymbolCount = m_nodeMgr->m_catchSymbolList.getCount();
+
+	// LaDfaTable only has the nodes which survived sharing
+
+	m_laDfaCount = 0;
+	sl::Iterator<LaDfaNode> laDfaIt = m_nodeMgr->m_laDfaList.getHead();
+	for (; laDfaIt; laDfaIt++)
+		if (laDfaIt->m_masterIndex != -1)
+			m_laDfaCount++;
+}
+
+sl::String
+CppGenerator::getDefineString(
+	const sl::StringRef& name,
+	const sl::StringRef& defaultValue
+) {
+	Define* define = m_module->m_defineMgr.findDefine(name);
+	if (!define)
+		return defaultValue;
+
+	switch (define->m_defineKind) {
+	case DefineKind_Integer:
+		return sl::formatString("%d", define->m_integerValue);
+
+	case DefineKind_Bool:
+		return define->m_integerValue ? "true" : "false";
+
+	default:
+		return define->m_stringValue;
+	}
+}
+
+bool
+CppGenerator::isDefineTrue(
+	const sl::StringRef& name,
+	bool defaultValue
+) {
+	// as in Lua, only the boolean false is false
+
+	Define* define = m_module->m_defineMgr.findDefine(name);
+	return define ?
+		define->m_defineKind != DefineKind_Bool || define->m_integerValue != 0 :
+		defaultValue;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+size_t
+CppGenerator::getLine() {
+	const char* p = m_buffer->cp();
+	size_t length = m_buffer->getLength();
+	for (size_t i = m_lineOffset; i < length; i++)
+		if (p[i] == '\n')
+			m_line++;
+
+	m_lineOffset = length;
+	return m_line;
+}
+
+void
+CppGenerator::trimOutput() {
+	m_buffer->trimRight();
+
+	if (m_lineOffset > m_buffer->getLength()) { // trimmed past the counted part, recount
+		m_line = 0;
+		m_lineOffset = 0;
+	}
+}
+
+void
+CppGenerator::appendPpLine(
+	const sl::StringRef& filePath,
+	size_t line
+) {
+	sl::String path = filePath;
+	char* p = path.getBuffer();
+	size_t length = path.getLength();
+	for (size_t i = 0; i < length; i++)
+		if (p[i] == '\\')
+			p[i] = '/';
+
+	m_buffer->appendFormat(m_ppLineFormat, line + 1, path.sz());
+}
+
+void
+CppGenerator::appendTokenString(SymbolNode* token) {
+	if (token->m_flags & SymbolNodeFlag_EofToken)
+		m_buffer->append("EofToken");
+	else if (token->m_flags & SymbolNodeFlag_AnyToken)
+		m_buffer->append("AnyToken");
+	else if (token->m_flags & SymbolNodeFlag_User)
+		m_buffer->append(token->m_name);
+	else if (token->m_charToken >= 0x20 && token->m_charToken < 0x7f) // [%g ]
+		m_buffer->appendFormat("'%c'", token->m_charToken);
+	else
+		m_buffer->appendFormat("%d", token->m_charToken);
+}
+
+void
+CppGenerator::appendTokenInfoString(size_t tokenIndex) {
+	size_t pragmaStartSymbol = m_nodeMgr->m_pragmaStartSymbol.m_index;
+	const char* flags = "0";
+	if (pragmaStartSymbol != -1) {
+		Node* production = m_module->m_parseTable.get(pragmaStartSymbol, tokenIndex);
+		if (production && production->m_masterIndex != 0)
+			flags = "llk::TokenInfoFlag_PragmaStart";
+	}
+
+	m_buffer->appendFormat(
+		"llk::TokenInfo(%d, %d, %s)",
+		tokenIndex,
+		m_module->m_tokenClassArray[tokenIndex],
+		flags
+	);
+}
+
+void
+CppGenerator::appendSymbolDeclaration(
+	SymbolNode* symbol,
+	const sl::StringRef& name,
+	const char* value
+) {
+	if (isCustomClass(symbol))
+		m_buffer->appendFormat(
+			"SymbolNode_%s* %s = (SymbolNode_%s*)%s;",
+			symbol->m_name.sz(),
+			name.sz(),
+			symbol->m_name.sz(),
+			value
+		);
+	else
+		m_buffer->appendFormat("SymbolNode* %s = %s;", name.sz(), value);
+}
+
+bool
+CppGenerator::appendUserCode(
+	const sl::StringRef& userCode,
+	DispatcherNode* dispatcher
+) {
+	const char* symbolName = m_symbolVariableName.sz();
+	const char* p = userCode.cp();
+	const char* end = userCode.getEnd();
+
+	while (p < end) {
+		const char* dollar = (const char*)memchr(p, '$', end - p);
+		if (!dollar) {
+			m_buffer->append(p, end - p);
+			break;
+		}
+
+		m_buffer->append(p, dollar - p);
+
+		const char* locator = dollar + 1;
+		p = locator;
+		while (p < end && isalnum((uchar_t)*p))
+			p++;
+
+		sl::StringRef locatorName(locator, p - locator);
+		if (locatorName.isEmpty()) {
+			m_buffer->appendFormat("%s->m_value", symbolName);
+			continue;
+		} else if (locatorName == "param") {
+			m_buffer->appendFormat("%s->m_param", symbolName);
+			continue;
+		} else if (locatorName == "local") {
+			m_buffer->appendFormat("%s->m_local", symbolName);
+			continue;
+		}
+
+		size_t slotIndex = 0;
+		const char* digit = locator;
+		for (; digit < p && *digit >= '0' && *digit <= '9'; digit++)
+			slotIndex = slotIndex * 10 + *digit - '0';
+
+		if (!dispatcher || digit < p || slotIndex >= dispatcher->m_beaconArray.getCount()) {
+			err::setFormatStringError("invalid locator $%s", locatorName.sz());
+			return false;
+		}
+
+		SymbolNode* symbol = dispatcher->m_beaconArray[slotIndex]->m_target;
+		if (symbol->m_nodeKind != NodeKind_Symbol)
+			m_buffer->appendFormat("(*getTokenLocator(%d))", slotIndex);
+		else if (!symbol->m_valueBlock.isEmpty())
+			m_buffer->appendFormat("(*(SymbolNodeValue_%s*)getSymbolLocator(%d))", symbol->m_name.sz(), slotIndex);
+		else
+			m_buffer->appendFormat("(*getSymbolLocator(%d))", slotIndex);
+	}
+
+	return true;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+bool
+CppGenerator::generateHeader() {
+	const char* parserClassName = m_parserClassName.sz();
+	const char* tokenClassName = m_tokenClassName.sz();
+
+	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
+	size_t tokenClassCount = m_module->m_tokenClassRepresentativeArray.getCount();
+	size_t symbolCount = m_nodeMgr->m_symbolArray.getCount();
+	size_t sequenceCount = m_nodeMgr->m_sequenceList.getCount();
+	size_t actionCount = m_nodeMgr->m_actionList.getCount();
+	size_t argumentCount = m_nodeMgr->m_argumentList.getCount();
+	size_t enterCount = m_nodeMgr->m_enterArray.getCount();
+	size_t leaveCount = m_nodeMgr->m_leaveArray.getCount();
+	size_t beaconCount = m_nodeMgr->m_beaconList.getCount();
+
+	size_t tokenEnd = tokenCount;
+	size_t symbolEnd = tokenEnd + symbolCount;
+	size_t sequenceEnd = symbolEnd + sequenceCount;
+	size_t actionEnd = sequenceEnd + actionCount;
+	size_t argumentEnd = actionEnd + argumentCount;
+	size_t beaconEnd = argumentEnd + beaconCount;
+	size_t laDfaEnd = beaconEnd + m_laDfaCount;
+
+	m_buffer->append(getDefineString("HeaderFileBegin"));
+	m_buffer->append('\n');
+	m_buffer->append(SeparatorLine);
+	m_buffer->append("\nenum SymbolKind {\n");
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++)
+		m_buffer->appendFormat("\tSymbolKind_%s = %d,\n", m_nodeMgr->m_symbolArray[i]->m_name.sz(), i);
+
+	m_buffer->append("};\n\n");
+	m_buffer->append(SeparatorLine);
+	m_buffer->appendFormat(
+		"\n"
+		"class %s: public llk::Parser<%s, %s> {\n"
+		"\tfriend class llk::Parser<%s, %s>;\n"
+		"\n",
+		parserClassName,
+		parserClassName,
+		tokenClassName,
+		parserClassName,
+		tokenClassName
+	);
+
+	m_buffer->append(getDefineString("Members"));
+	m_buffer->append(
+		"\n"
+		"\n"
+		"protected:\n"
+		"\tclass TokenMap: public axl::sl::SimpleHashTable<int, llk::TokenInfo> {\n"
+		"\tpublic:\n"
+		"\t\tTokenMap();\n"
+		"\t};\n"
+		"\n"
+		"\t// custom symbols\n"
+		"\n"
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++) {
+		SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+		if (!isCustomClass(symbol))
+			continue;
+
+		const char* name = symbol->m_name.sz();
+		const sl::String& filePath = symbol->m_srcPos.m_filePath;
+
+		if (!symbol->m_valueBlock.isEmpty()) {
+			m_buffer->appendFormat("\tstruct SymbolNodeValue_%s {\n", name);
+			appendPpLine(filePath, symbol->m_valueLineCol.m_line);
+			m_buffer->append("\n\t");
+			m_buffer->append(symbol->m_valueBlock);
+			m_buffer->append(";\n");
+			appendPpLineDefault();
+			m_buffer->appendFormat(
+				"\n"
+				"\t};\n"
+				"\n"
+				"\tstruct SymbolNode_%s: llk::SymbolNodeImpl<SymbolNodeValue_%s> {\n",
+				name,
+				name
+			);
+		} else {
+			m_buffer->appendFormat("\tstruct SymbolNode_%s: llk::SymbolNode {\n", name);
+		}
+
+		if (!symbol->m_paramBlock.isEmpty()) {
+			sl::String paramBlock = symbol->m_paramBlock;
+			char* p = paramBlock.getBuffer();
+			size_t length = paramBlock.getLength();
+			for (size_t j = 0; j < length; j++)
+				if (p[j] == ',')
+					p[j] = ';';
+
+			m_buffer->append("\t\tstruct {\n");
+			appendPpLine(filePath, symbol->m_paramLineCol.m_line);
+			m_buffer->append("\n\t\t\t");
+			m_buffer->append(paramBlock);
+			m_buffer->append(";\n");
+			appendPpLineDefault();
+			m_buffer->append("\n\t\t} m_param;\n");
+		}
+
+		if (!symbol->m_localBlock.isEmpty()) {
+			m_buffer->append("\t\tstruct {\n");
+			appendPpLine(filePath, symbol->m_localLineCol.m_line);
+			m_buffer->append("\n\t\t\t");
+			m_buffer->append(symbol->m_localBlock);
+			m_buffer->append(";\n");
+			appendPpLineDefault();
+			m_buffer->append("\n\t\t} m_local;\n");
+		}
+
+		m_buffer->append("\t};\n\n");
+	}
+
+	m_buffer->append(
+		"\tunion MaxNodeSizeCalc {\n"
+		"\t\tchar m_laDfaNode[sizeof(LaDfaNode)];\n"
+		"\t\tchar m_tokenNode[sizeof(TokenNode)];\n"
+		"\t\tchar m_stdSymbolNode[sizeof(SymbolNode)];\n"
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++) {
+		SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+		if (isCustomClass(symbol))
+			m_buffer->appendFormat(
+				"\t\tchar m_symbolNode_%s[sizeof(SymbolNode_%s)];\n",
+				symbol->m_name.sz(),
+				symbol->m_name.sz()
+			);
+	}
+
+	SymbolNode* startSymbol = m_nodeMgr->m_primaryStartSymbol;
+
+	m_buffer->appendFormat(
+		"\t};\n"
+		"\n"
+		"public:\n"
+		"\tenum {\n"
+		"\t\tStartSymbol        = %d,\n"
+		"\t\tPragmaStartSymbol  = %d,\n"
+		"\t\tEofToken           = 0,\n"
+		"\t\tAnyToken           = 1,\n"
+		"\n",
+		startSymbol ? (int)startSymbol->m_index : -1,
+		(int)m_nodeMgr->m_pragmaStartSymbol.m_index
+	);
+
+	m_buffer->appendFormat(
+		"\t\tTokenCount         = %d,\n"
+		"\t\tTokenClassCount    = %d,\n"
+		"\t\tNamedSymbolCount   = %d,\n"
+		"\t\tCatchSymbolCount   = %d,\n"
+		"\t\tSymbolCount        = %d,\n"
+		"\t\tSequenceCount      = %d,\n"
+		"\t\tActionCount        = %d,\n"
+		"\t\tArgumentCount      = %d,\n"
+		"\t\tEnterCount         = %d,\n"
+		"\t\tLeaveCount         = %d,\n"
+		"\t\tBeaconCount        = %d,\n"
+		"\t\tLaDfaCount         = %d,\n"
+		"\t\tTotalCount         = %d,\n"
+		"\n",
+		tokenCount,
+		tokenClassCount,
+		m_namedSymbolCount,
+		m_catchSymbolCount,
+		symbolCount,
+		sequenceCount,
+		actionCount,
+		argumentCount,
+		enterCount,
+		leaveCount,
+		beaconCount,
+		m_laDfaCount,
+		laDfaEnd
+	);
+
+	m_buffer->appendFormat(
+		"\t\tTokenFirst         = 0,\n"
+		"\t\tTokenEnd           = %d,\n"
+		"\t\tSymbolFirst        = %d,\n"
+		"\t\tSymbolEnd          = %d,\n"
+		"\t\tSequenceFirst      = %d,\n"
+		"\t\tSequenceEnd        = %d,\n"
+		"\t\tActionFirst        = %d,\n"
+		"\t\tActionEnd          = %d,\n"
+		"\t\tArgumentFirst      = %d,\n"
+		"\t\tArgumentEnd        = %d,\n"
+		"\t\tBeaconFirst        = %d,\n"
+		"\t\tBeaconEnd          = %d,\n"
+		"\t\tLaDfaFirst         = %d,\n"
+		"\t\tLaDfaEnd           = %d,\n"
+		"\n"
+		"\t\tMaxNodeSize        = sizeof(MaxNodeSizeCalc),\n"
+		"\t};\n"
+		"\n",
+		tokenEnd,
+		tokenEnd,
+		symbolEnd,
+		symbolEnd,
+		sequenceEnd,
+		sequenceEnd,
+		actionEnd,
+		actionEnd,
+		argumentEnd,
+		argumentEnd,
+		beaconEnd,
+		beaconEnd,
+		laDfaEnd
+	);
+
+	m_buffer->append(
+		"protected:\n"
+		"\tstatic\n"
+		"\tconst size_t*\n"
+		"\tgetParseTable();\n"
+		"\n"
+		"\tstatic\n"
+		"\tsize_t\n"
+		"\tgetTokenClassCount() {\n"
+		"\t\treturn TokenClassCount;\n"
+		"\t}\n"
+		"\n"
+		"\tstatic\n"
+		"\tconst size_t*\n"
+		"\tgetSequence(size_t index);\n"
+		"\n"
+		"\tstatic\n"
+		"\tllk::TokenInfo\n"
+		"\tgetTokenInfo(int token);\n"
+		"\n"
+		"\tstatic\n"
+		"\tint\n"
+		"\tgetTokenFromIndex(size_t index);\n"
+		"\n"
+		"\tstatic\n"
+		"\tconst char*\n"
+		"\tgetSymbolName(size_t index);\n"
+		"\n"
+		"\tSymbolNode*\n"
+		"\tcreateSymbolNode(size_t index);\n"
+		"\n"
+		"\tstatic\n"
+		"\tconst size_t*\n"
+		"\tgetStackDepthHint(size_t index);\n"
+		"\n"
+		"\tstatic\n"
+		"\tconst size_t*\n"
+		"\tgetBeacon(size_t index);\n"
+		"\n"
+		"\tbool\n"
+		"\taction(size_t index);\n"
+		"\n"
+		"\tvoid\n"
+		"\targument(\n"
+		"\t\tsize_t index,\n"
+		"\t\tSymbolNode* symbol\n"
+		"\t);\n"
+		"\n"
+		"\tbool\n"
+		"\tenter(size_t index);\n"
+		"\n"
+		"\tbool\n"
+		"\tleave(size_t index);\n"
+		"\n"
+		"\tLaDfaResult\n"
+		"\tlaDfa(\n"
+		"\t\tsize_t index,\n"
+		"\t\tint lookaheadToken,\n"
+		"\t\tLaDfaTransition* transition\n"
+		"\t);\n"
+		"\n"
+		"\tconst int*\n"
+		"\tgetSyncTokenSet(size_t index);\n"
+		"\n"
+		"private:\n"
+		"\t// symbol nodes\n"
+		"\n"
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++) {
+		SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+		if (hasCreateFunc(symbol))
+			m_buffer->appendFormat(
+				"\tSymbolNode*\n"
+				"\tcreateSymbolNode_%s(size_t index);\n"
+				"\n",
+				symbol->m_name.sz()
+			);
+	}
+
+	m_buffer->append(
+		"\tSymbolNode*\n"
+		"\tcreateStdSymbolNode(size_t index);\n"
+		"\n"
+		"\t// actions\n"
+		"\n"
+	);
+
+	for (size_t i = 0; i < actionCount; i++)
+		m_buffer->appendFormat("\tbool\n\taction_%d();\n\n", i);
+
+	m_buffer->append("\t// arguments\n\n");
+
+	for (size_t i = 0; i < argumentCount; i++)
+		m_buffer->appendFormat("\tvoid\n\targument_%d(SymbolNode* symbol);\n\n", i);
+
+	m_buffer->append("\t// enter\n\n");
+
+	for (size_t i = 0; i < enterCount; i++)
+		m_buffer->appendFormat("\tbool\n\tenter_%s();\n\n", m_nodeMgr->m_enterArray[i]->m_name.sz());
+
+	m_buffer->append("\t// leave\n\n");
+
+	for (size_t i = 0; i < leaveCount; i++)
+		m_buffer->appendFormat("\tbool\n\tleave_%s();\n\n", m_nodeMgr->m_leaveArray[i]->m_name.sz());
+
+	m_buffer->append("\t// lookahead DFA\n\n");
+
+	for (size_t i = 0; i < m_laDfaCount; i++)
+		m_buffer->appendFormat(
+			"\tLaDfaResult\n"
+			"\tlaDfa_%d(\n"
+			"\t\tint lookaheadToken,\n"
+			"\t\tLaDfaTransition* transition\n"
+			"\t);\n"
+			"\n",
+			i
+		);
+
+	m_buffer->append("};\n\n");
+	m_buffer->append(SeparatorLine);
+	m_buffer->append('\n');
+	m_buffer->append(getDefineString("HeaderFileEnd"));
+	m_buffer->append('\n');
+	return true;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+bool
+CppGenerator::generateSource() {
+	m_buffer->append(getDefineString("CppFileBegin"));
+	m_buffer->append(
+		"\n"
+		"\n"
+		"#pragma warning(disable: 4065) // warning C4065: switch statement contains 'default' but no 'case' labels\n"
+		"\n"
+	);
+
+	m_buffer->append(SeparatorLine);
+
+	if (!m_shardIndex) {
+		generateParseTables();
+		m_buffer->append(SubSeparatorLine);
+		generateTokens();
+		m_buffer->append(SubSeparatorLine);
+		generateSymbols();
+		m_buffer->append(SubSeparatorLine);
+	}
+
+	bool result = generateUserCode();
+	if (!result)
+		return false;
+
+	m_buffer->append(SubSeparatorLine);
+	generateLaDfas();
+
+	if (!m_shardIndex) {
+		m_buffer->append(SubSeparatorLine);
+		generateSyncTokenSets();
+	}
+
+	m_buffer->append(SeparatorLine);
+	m_buffer->append('\n');
+	m_buffer->append(getDefineString("CppFileEnd"));
+	m_buffer->append('\n');
+	return true;
+}
+
+void
+CppGenerator::generateParseTables() {
+	const char* parserClassName = m_parserClassName.sz();
+	const ParseTable& parseTable = m_module->m_parseTable;
+	const sl::Array<size_t>& representativeArray = m_module->m_tokenClassRepresentativeArray;
+
+	size_t symbolCount = m_nodeMgr->m_symbolArray.getCount();
+	size_t tokenClassCount = representativeArray.getCount();
+
+	m_buffer->appendFormat(
+		"\n"
+		"// parse tables\n"
+		"\n"
+		"const size_t*\n"
+		"%s::getParseTable() {\n"
+		"\tstatic const size_t parseTable[] = {\n",
+		parserClassName
+	);
+
+	for (size_t i = 0; i < symbolCount; i++) {
+		m_buffer->append("\t\t");
+
+		for (size_t j = 0; j < tokenClassCount; j++) {
+			Node* production = parseTable.get(i, representativeArray[j]);
+			m_buffer->appendFormat("%d, ", production ? (int)production->m_masterIndex : -1);
+		}
+
+		trimOutput();
+		m_buffer->append('\n');
+	}
+
+	m_buffer->appendFormat(
+		"\t\t-1\n"
+		"\t};\n"
+		"\n"
+		"\treturn parseTable;\n"
+		"}\n"
+		"\n"
+		"const size_t*\n"
+		"%s::getSequence(size_t index) {\n"
+		"\tASSERT(index < SequenceCount);\n"
+		"\n"
+		"\tstatic const size_t sequenceTable[] = {\n",
+		parserClassName
+	);
+
+	sl::Iterator<SequenceNode> sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+	for (size_t i = 0; sequenceIt; sequenceIt++, i++) {
+		const sl::Array<GrammarNode*>& sequence = sequenceIt->m_sequence;
+		m_buffer->appendFormat("\t\t/* %2d */  ", i);
+
+		for (size_t j = sequence.getCount(); j; j--)
+			m_buffer->appendFormat("%d, ", sequence[j - 1]->m_masterIndex);
+
+		m_buffer->append("-1,\n");
+	}
+
+	m_buffer->append(
+		"\t\t-1\n"
+		"\t};\n"
+		"\n"
+		"\tstatic const size_t sequenceIndexTable[] = {\n"
+	);
+
+	size_t offset = 0;
+	sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+	for (; sequenceIt; sequenceIt++) {
+		m_buffer->appendFormat("\t\t%d,\n", offset);
+		offset += sequenceIt->m_sequence.getCount() + 1; // including the terminating -1
+	}
+
+	m_buffer->append(
+		"\t\t-1\n"
+		"\t};\n"
+		"\n"
+		"\treturn sequenceTable + sequenceIndexTable[index];\n"
+		"}\n"
+		"\n"
+	);
+}
+
+void
+CppGenerator::generateTokens() {
+	const char* parserClassName = m_parserClassName.sz();
+	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
+
+	m_buffer->appendFormat(
+		"\n"
+		"// tokens\n"
+		"\n"
+		"%s::TokenMap::TokenMap() {\n"
+		"\tadd(0, ",
+		parserClassName
+	);
+
+	appendTokenInfoString(0);
+	m_buffer->append(");\n");
+
+	for (size_t i = 2; i < tokenCount; i++) {
+		m_buffer->append("\tadd(");
+		appendTokenString(m_nodeMgr->m_tokenArray[i]);
+		m_buffer->append(", ");
+		appendTokenInfoString(i);
+		m_buffer->append(");\n");
+	}
+
+	m_buffer->appendFormat(
+		"}\n"
+		"\n"
+		"llk::TokenInfo\n"
+		"%s::getTokenInfo(int token) {\n"
+		"\treturn axl::sl::getSingleton<TokenMap>()->findValue(token, ",
+		parserClassName
+	);
+
+	appendTokenInfoString(1);
+
+	m_buffer->appendFormat(
+		");\n"
+		"}\n"
+		"\n"
+		"int\n"
+		"%s::getTokenFromIndex(size_t index) {\n"
+		"\tASSERT(index < TokenCount);\n"
+		"\n"
+		"\tstatic const int tokenTable[] = {\n"
+		"\t\t0,  // eof\n"
+		"\t\t0,  // any token\n",
+		parserClassName
+	);
+
+	for (size_t i = 2; i < tokenCount; i++) {
+		m_buffer->append("\t\t");
+		appendTokenString(m_nodeMgr->m_tokenArray[i]);
+		m_buffer->append(",\n");
+	}
+
+	m_buffer->append(
+		"\t\t0\n"
+		"\t};\n"
+		"\n"
+		"\treturn tokenTable[index];\n"
+		"}\n"
+		"\n"
+	);
+}
+
+void
+CppGenerator::generateSymbols() {
+	const char* parserClassName = m_parserClassName.sz();
+
+	m_buffer->appendFormat(
+		"\n"
+		"// symbols\n"
+		"\n"
+		"const char*\n"
+		"%s::getSymbolName(size_t index) {\n"
+		"\tASSERT(index < SymbolCount);\n"
+		"\n"
+		"\tstatic const char* symbolNameTable[NamedSymbolCount + 1] = {\n",
+		parserClassName
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++)
+		m_buffer->appendFormat("\t\t\"%s\",\n", m_nodeMgr->m_symbolArray[i]->m_name.sz());
+
+	m_buffer->appendFormat(
+		"\t\tNULL\n"
+		"\t};\n"
+		"\n"
+		"\treturn\n"
+		"\t\tindex < NamedSymbolCount ? symbolNameTable[index] :\n"
+		"\t\tindex < NamedSymbolCount + CatchSymbolCount ? \"<catch>\" :\n"
+		"\t\t\"<tmp>\";\n"
+		"}\n"
+		"\n"
+		"%s::SymbolNode*\n"
+		"%s::createSymbolNode(size_t index) {\n"
+		"\tASSERT(index < NamedSymbolCount);\n"
+		"\n"
+		"\ttypedef\n"
+		"\tSymbolNode*\n"
+		"\t(%s::*CreateFunc)(size_t index);\n"
+		"\n"
+		"\tstatic CreateFunc const createFuncTable[NamedSymbolCount + 1] = {\n",
+		parserClassName,
+		parserClassName,
+		parserClassName
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++) {
+		SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+		if (hasCreateFunc(symbol))
+			m_buffer->appendFormat("\t\t&%s::createSymbolNode_%s,\n", parserClassName, symbol->m_name.sz());
+		else
+			m_buffer->appendFormat("\t\t&%s::createStdSymbolNode,\n", parserClassName);
+	}
+
+	m_buffer->append(
+		"\t\tNULL\n"
+		"\t};\n"
+		"\n"
+		"\treturn (this->*createFuncTable[index])(index);\n"
+		"}\n"
+		"\n"
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++) {
+		SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+		if (!hasCreateFunc(symbol))
+			continue;
+
+		const char* name = symbol->m_name.sz();
+
+		m_buffer->appendFormat(
+			"%s::SymbolNode*\n"
+			"%s::createSymbolNode_%s(size_t index) {\n",
+			parserClassName,
+			parserClassName,
+			name
+		);
+
+		if (isCustomClass(symbol))
+			m_buffer->appendFormat("\tSymbolNode* node = m_nodeAllocator->allocate<SymbolNode_%s>();\n", name);
+		else
+			m_buffer->append("\tSymbolNode* node = m_nodeAllocator->allocate<SymbolNode>();\n");
+
+		m_buffer->append("\tnode->m_index = index;\n");
+
+		if (!symbol->m_enterBlock.isEmpty())
+			m_buffer->appendFormat("\tnode->m_enterIndex = %d;\n", symbol->m_enterIndex);
+
+		if (!symbol->m_leaveBlock.isEmpty())
+			m_buffer->appendFormat("\tnode->m_leaveIndex = %d;\n", symbol->m_leaveIndex);
+
+		m_buffer->append(
+			"\tnode->m_nodeAllocator = m_nodeAllocator;\n"
+			"\treturn node;\n"
+			"}\n"
+			"\n"
+			"\n"
+		);
+	}
+
+	m_buffer->appendFormat(
+		"%s::SymbolNode*\n"
+		"%s::createStdSymbolNode(size_t index) {\n"
+		"\tSymbolNode* node = m_nodeAllocator->allocate<SymbolNode>();\n"
+		"\tnode->m_index = index;\n"
+		"\tnode->m_nodeAllocator = m_nodeAllocator;\n"
+		"\treturn node;\n"
+		"}\n"
+		"\n"
+		"const size_t*\n"
+		"%s::getStackDepthHint(size_t index) {\n"
+		"\tASSERT(index < NamedSymbolCount);\n"
+		"\n"
+		"\t// prediction, symbol, catch, resolver\n"
+		"\n"
+		"\tstatic const size_t stackDepthTable[NamedSymbolCount + 1][4] = {\n",
+		parserClassName,
+		parserClassName,
+		parserClassName
+	);
+
+	for (size_t i = 0; i < m_namedSymbolCount; i++) {
+		SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+		m_buffer->appendFormat(
+			"\t\t{ %d, %d, %d, %d }, // %s\n",
+			symbol->m_stackDepth.m_predictionDepth,
+			symbol->m_stackDepth.m_symbolDepth,
+			symbol->m_stackDepth.m_catchDepth,
+			symbol->m_stackDepth.m_resolverDepth,
+			symbol->m_name.sz()
+		);
+	}
+
+	// the trailing row is never looked up (see CppParser.cpp.in)
+
+	m_buffer->append(
+		"\t\t{ 0 }\n"
+		"\t};\n"
+		"\n"
+		"\treturn stackDepthTable[index];\n"
+		"}\n"
+		"\n"
+	);
+
+	m_buffer->append(SubSeparatorLine);
+	m_buffer->appendFormat(
+		"\n"
+		"// beacons\n"
+		"\n"
+		"const size_t*\n"
+		"%s::getBeacon(size_t index) {\n"
+		"\tASSERT(index < BeaconCount);\n"
+		"\n"
+		"\tstatic const size_t beaconTable[BeaconCount + 1][2] = {\n",
+		parserClassName
+	);
+
+	sl::Iterator<BeaconNode> beaconIt = m_nodeMgr->m_beaconList.getHead();
+	for (; beaconIt; beaconIt++)
+		m_buffer->appendFormat(
+			"\t\t{ %d, %d },\n",
+			beaconIt->m_slotIndex,
+			beaconIt->m_target->m_masterIndex
+		);
+
+	m_buffer->append(
+		"\t\t{ 0 }\n"
+		"\t};\n"
+		"\n"
+		"\treturn beaconTable[index];\n"
+		"}\n"
+		"\n"
+	);
+}
+
+bool
+CppGenerator::generateUserCode() {
+	bool result;
+
+	const char* parserClassName = m_parserClassName.sz();
+	const char* symbolVariableName = m_symbolVariableName.sz();
+	const char* targetVariableName = m_targetVariableName.sz();
+	const ShardMap& shardMap = m_module->m_shardMap;
+
+	// actions
+
+	m_buffer->append("\n// actions\n\n");
+
+	if (!m_shardIndex) {
+		m_buffer->appendFormat(
+			"bool\n"
+			"%s::action(size_t index) {\n"
+			"\tASSERT(index < ActionCount);\n"
+			"\n"
+			"\ttypedef\n"
+			"\tbool\n"
+			"\t(%s::*ActionFunc)();\n"
+			"\n"
+			"\tstatic const ActionFunc actionFuncTable[ActionCount + 1]  = {\n",
+			parserClassName,
+			parserClassName
+		);
+
+		size_t actionCount = m_nodeMgr->m_actionList.getCount();
+		for (size_t i = 0; i < actionCount; i++)
+			m_buffer->appendFormat("\t\t&%s::action_%d,\n", parserClassName, i);
+
+		m_buffer->append(
+			"\t\tNULL\n"
+			"\t};\n"
+			"\n"
+			"\treturn (this->*(actionFuncTable[index]))();\n"
+			"}\n"
+			"\n"
+		);
+	}
+
+	sl::Iterator<ActionNode> actionIt = m_nodeMgr->m_actionList.getHead();
+	for (size_t i = 0; actionIt; actionIt++, i++) {
+		if (shardMap.getShard(ShardFunc_Action, i) != m_shardIndex)
+			continue;
+
+		ActionNode* action = *actionIt;
+
+		m_buffer->appendFormat("bool\n%s::action_%d() {\n\t", parserClassName, i);
+		appendSymbolDeclaration(action->m_productionSymbol, symbolVariableName, "getSymbolTop()");
+		m_buffer->append('\n');
+		appendPpLine(action->m_srcPos.m_filePath, action->m_srcPos.m_line);
+		m_buffer->append('\n');
+
+		result = appendUserCode(action->m_userCode, action->m_dispatcher);
+		if (!result)
+			return false;
+
+		m_buffer->append(";\n");
+		appendPpLineDefault();
+		m_buffer->append("\n\treturn true;\n}\n\n");
+	}
+
+	// arguments
+
+	m_buffer->append(SubSeparatorLine);
+	m_buffer->append("\n// arguments\n\n");
+
+	if (!m_shardIndex) {
+		m_buffer->appendFormat(
+			"void\n"
+			"%s::argument(\n"
+			"\tsize_t index,\n"
+			"\tSymbolNode* symbol\n"
+			") {\n"
+			"\tASSERT(index < ArgumentCount);\n"
+			"\n"
+			"\ttypedef\n"
+			"\tvoid\n"
+			"\t(%s::*ArgumentFunc)(SymbolNode* symbol);\n"
+			"\n"
+			"\tstatic const ArgumentFunc argumentFuncTable[ArgumentCount + 1]  = {\n",
+			parserClassName,
+			parserClassName
+		);
+
+		size_t argumentCount = m_nodeMgr->m_argumentList.getCount();
+		for (size_t i = 0; i < argumentCount; i++)
+			m_buffer->appendFormat("\t\t&%s::argument_%d,\n", parserClassName, i);
+
+		m_buffer->append(
+			"\t\tNULL\n"
+			"\t};\n"
+			"\n"
+			"\t(this->*(argumentFuncTable[index]))(symbol);\n"
+			"}\n"
+			"\n"
+		);
+	}
+
+	sl::Iterator<ArgumentNode> argumentIt = m_nodeMgr->m_argumentList.getHead();
+	for (size_t i = 0; argumentIt; argumentIt++, i++) {
+		if (shardMap.getShard(ShardFunc_Argument, i) != m_shardIndex)
+			continue;
+
+		ArgumentNode* argument = *argumentIt;
+
+		m_buffer->appendFormat("void\n%s::argument_%d(SymbolNode* symbol) {\n\t", parserClassName, i);
+		appendSymbolDeclaration(argument->m_targetSymbol, targetVariableName, "symbol");
+		m_buffer->append("\n\t");
+		appendSymbolDeclaration(argument->m_productionSymbol, symbolVariableName, "getSymbolTop()");
+		m_buffer->append('\n');
+
+		sl::BoxIterator<sl::StringRef> nameIt = argument->m_targetSymbol->m_paramNameList.getHead();
+		sl::BoxIterator<sl::String> valueIt = argument->m_argValueList.getHead();
+		for (; valueIt; valueIt++) {
+			appendPpLine(argument->m_srcPos.m_filePath, argument->m_srcPos.m_line);
+			m_buffer->appendFormat("\n\t\t%s->m_param.", targetVariableName);
+
+			if (nameIt) {
+				m_buffer->append(*nameIt);
+				nameIt++;
+			}
+
+			m_buffer->append(" = ");
+
+			result = appendUserCode(*valueIt, argument->m_dispatcher);
+			if (!result)
+				return false;
+
+			m_buffer->append(";\n");
+			appendPpLineDefault();
+			m_buffer->append('\n');
+		}
+
+		m_buffer->append("}\n\n");
+	}
+
+	// enter & leave blocks
+
+	for (size_t k = 0; k < 2; k++) {
+		bool isEnter = k == 0;
+		const char* kind = isEnter ? "enter" : "leave";
+		const char* funcKind = isEnter ? "Enter" : "Leave";
+		ShardFunc shardFunc = isEnter ? ShardFunc_Enter : ShardFunc_Leave;
+		const sl::Array<SymbolNode*>& symbolArray = isEnter ? m_nodeMgr->m_enterArray : m_nodeMgr->m_leaveArray;
+		size_t count = symbolArray.getCount();
+
+		m_buffer->append(SubSeparatorLine);
+		m_buffer->appendFormat("\n// %s blocks\n\n", kind);
+
+		if (!m_shardIndex) {
+			m_buffer->appendFormat(
+				"bool\n"
+				"%s::%s(size_t index) {\n"
+				"\tASSERT(index < %sCount);\n"
+				"\n"
+				"\ttypedef\n"
+				"\tbool\n"
+				"\t(%s::*%sFunc)();\n"
+				"\n"
+				"\tstatic const %sFunc %sFuncTable[%sCount + 1]  = {\n",
+				parserClassName,
+				kind,
+				funcKind,
+				parserClassName,
+				funcKind,
+				funcKind,
+				kind,
+				funcKind
+			);
+
+			for (size_t i = 0; i < count; i++)
+				m_buffer->appendFormat("\t\t&%s::%s_%s,\n", parserClassName, kind, symbolArray[i]->m_name.sz());
+
+			m_buffer->appendFormat(
+				"\t\tNULL\n"
+				"\t};\n"
+				"\n"
+				"\treturn (this->*(%sFuncTable[index]))();\n"
+				"}\n"
+				"\n",
+				kind
+			);
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			if (shardMap.getShard(shardFunc, i) != m_shardIndex)
+				continue;
+
+			SymbolNode* symbol = symbolArray[i];
+
+			m_buffer->appendFormat("bool\n%s::%s_%s() {\n\t", parserClassName, kind, symbol->m_name.sz());
+			appendSymbolDeclaration(symbol, symbolVariableName, "getSymbolTop()");
+			m_buffer->append('\n');
+			appendPpLine(
+				symbol->m_srcPos.m_filePath,
+				isEnter ? symbol->m_enterLineCol.m_line : symbol->m_leaveLineCol.m_line
+			);
+
+			m_buffer->append('\n');
+
+			result = appendUserCode(isEnter ? symbol->m_enterBlock : symbol->m_leaveBlock, NULL);
+			if (!result)
+				return false;
+
+			m_buffer->append(";\n");
+			appendPpLineDefault();
+			m_buffer->append("\n\treturn true;\n}\n\n");
+		}
+	}
+
+	return true;
+}
+
+void
+CppGenerator::appendLaDfaResolver(
+	LaDfaNode* node,
+	const char* indent
+) {
+	m_buffer->appendFormat(
+		"%stransition->m_productionIndex = %d;\n"
+		"%stransition->m_resolverIndex = %d;\n"
+		"%stransition->m_resolverElseIndex = %d;\n",
+		indent,
+		node->m_production->m_masterIndex,
+		indent,
+		node->m_resolver->m_masterIndex,
+		indent,
+		getTransitionIndex(node->m_resolverElse)
+	);
+
+	if (((LaDfaNode*)node->m_resolverElse)->m_resolver)
+		m_buffer->appendFormat("%stransition->m_flags = llk::LaDfaNodeFlag_HasChainedResolver;\n", indent);
+
+	m_buffer->appendFormat("%sreturn LaDfaResult_Resolver;\n", indent);
+}
+
+void
+CppGenerator::generateLaDfas() {
+	const char* parserClassName = m_parserClassName.sz();
+	const ShardMap& shardMap = m_module->m_shardMap;
+
+	m_buffer->append("\n// lookahead DFAs\n\n");
+
+	if (!m_shardIndex) {
+		m_buffer->appendFormat(
+			"%s::LaDfaResult\n"
+			"%s::laDfa(\n"
+			"\tsize_t index,\n"
+			"\tint lookaheadToken,\n"
+			"\tLaDfaTransition* transition\n"
+			") {\n"
+			"\tASSERT(index < LaDfaCount);\n"
+			"\n"
+			"\ttypedef\n"
+			"\tLaDfaResult\n"
+			"\t(%s::*LaDfaFunc)(\n"
+			"\t\tint lookaheadToken,\n"
+			"\t\tLaDfaTransition* transition\n"
+			"\t);\n"
+			"\n"
+			"\tstatic const LaDfaFunc laDfaFuncTable[LaDfaCount + 1] = {\n",
+			parserClassName,
+			parserClassName,
+			parserClassName
+		);
+
+		for (size_t i = 0; i < m_laDfaCount; i++)
+			m_buffer->appendFormat("\t\t&%s::laDfa_%d,\n", parserClassName, i);
+
+		m_buffer->append(
+			"\t\tNULL\n"
+			"\t};\n"
+			"\n"
+			"\treturn (this->*(laDfaFuncTable[index]))(lookaheadToken, transition);\n"
+			"}\n"
+			"\n"
+		);
+	}
+
+	sl::Iterator<LaDfaNode> nodeIt = m_nodeMgr->m_laDfaList.getHead();
+	for (size_t i = 0; nodeIt; nodeIt++) {
+		LaDfaNode* node = *nodeIt;
+		if (node->m_masterIndex == -1)
+			continue;
+
+		size_t index = i++;
+		if (shardMap.getShard(ShardFunc_LaDfa, index) != m_shardIndex)
+			continue;
+
+		ASSERT(!(node->m_flags & LaDfaNodeFlag_Leaf));
+
+		m_buffer->appendFormat(
+			"%s::LaDfaResult\n"
+			"%s::laDfa_%d(\n"
+			"\tint lookaheadToken,\n"
+			"\tLaDfaTransition* transition\n"
+			") {\n",
+			parserClassName,
+			parserClassName,
+			index
+		);
+
+		if (node->m_resolver) {
+			appendLaDfaResolver(node, "\t");
+			m_buffer->append("}\n\n");
+			continue;
+		}
+
+		m_buffer->append("\tswitch (lookaheadToken) {\n");
+
+		Node* defaultProduction = node->m_production;
+
+		size_t count = node->m_transitionArray.getCount();
+		for (size_t j = 0; j < count; j++) {
+			SymbolNode* token = node->m_transitionArray[j].m_token;
+			LaDfaNode* child = node->m_transitionArray[j].m_node;
+
+			if ((token->m_flags & SymbolNodeFlag_AnyToken) && !defaultProduction)
+				defaultProduction = child->m_production;
+
+			m_buffer->append("\tcase ");
+			appendTokenString(token);
+			m_buffer->append(":\n");
+
+			if (child->m_resolver)
+				appendLaDfaResolver(child, "\t\t");
+			else
+				m_buffer->appendFormat(
+					"\t\ttransition->m_productionIndex = %d;\n"
+					"\t\treturn LaDfaResult_Production;\n",
+					getTransitionIndex(child)
+				);
+
+			m_buffer->append('\n');
+		}
+
+		m_buffer->append("\tdefault:\n");
+
+		if (defaultProduction)
+			m_buffer->appendFormat(
+				"\t\ttransition->m_productionIndex = %d;\n"
+				"\t\treturn LaDfaResult_Production;\n",
+				getTransitionIndex(defaultProduction)
+			);
+		else
+			m_buffer->append("\t\treturn LaDfaResult_Fail;\n");
+
+		m_buffer->append("\t}\n}\n\n");
+	}
+}
+
+void
+CppGenerator::generateSyncTokenSets() {
+	m_buffer->appendFormat(
+		"\n"
+		"// synchornization tokens\n"
+		"\n"
+		"const int*\n"
+		"%s::getSyncTokenSet(size_t index) {\n"
+		"\tASSERT(index >= NamedSymbolCount && index < NamedSymbolCount + CatchSymbolCount);\n"
+		"\n"
+		"\tstatic const int syncTokenTable[] = {\n",
+		m_parserClassName.sz()
+	);
+
+	size_t end = m_namedSymbolCount + m_catchSymbolCount;
+	for (size_t i = m_namedSymbolCount; i < end; i++) {
+		GrammarNode* synchronizer = m_nodeMgr->m_symbolArray[i]->m_synchronizer;
+		m_buffer->appendFormat("\t\t/* %2d */  ", i - m_namedSymbolCount);
+
+		size_t count = synchronizer ? synchronizer->m_firstArray.getCount() : 0;
+		for (size_t j = 0; j < count; j++) {
+			appendTokenString(synchronizer->m_firstArray[j]);
+			m_buffer->append(", ");
+		}
+
+		m_buffer->append("-1,\n");
+	}
+
+	m_buffer->append(
+		"\t\t-1\n"
+		"\t};\n"
+		"\n"
+		"\tstatic const size_t syncTokenIndexTable[] = {\n"
+	);
+
+	size_t offset = 0;
+	for (size_t i = m_namedSymbolCount; i < end; i++) {
+		GrammarNode* synchronizer = m_nodeMgr->m_symbolArray[i]->m_synchronizer;
+		m_buffer->appendFormat("\t\t%d,\n", offset);
+		offset += (synchronizer ? synchronizer->m_firstArray.getCount() : 0) + 1; // including the terminating -1
+	}
+
+	m_buffer->append(
+		"\t\t-1\n"
+		"\t};\n"
+		"\n"
+		"\treturn syncTokenTable + syncTokenIndexTable[index - NamedSymbolCount];\n"
+		"}\n"
+		"\n"
+	);
+}
+
+//..............................................................................
@@ -0,0 +1,176 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "Node.h"
+
+struct CmdLine;
+class Module;
+class NodeMgr;
+
+//..............................................................................
+
+enum CppFrameKind {
+	CppFrameKind_None,
+	CppFrameKind_Header, // CppParser.h.in
+	CppFrameKind_Source, // CppParser.cpp.in
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// native counterpart of the standard C++ frames (and CppParserUtils.lua): emits
+// the very same text without exporting the grammar to Lua. Must be kept in sync
+// with frame/CppParser.h.in & frame/CppParser.cpp.in. Only the frames in the
+// bundled frame directories (source tree & install prefix) are recognized;
+// customized copies of the standard frames go through Lua
+
+class CppGenerator {
+protected:
+	const CmdLine* m_cmdLine;
+	Module* m_module;
+	NodeMgr* m_nodeMgr;
+	sl::String* m_buffer;
+	sl::String m_targetFilePath;
+	size_t m_shardIndex;
+	size_t m_line;       // lines in m_buffer up to m_lineOffset
+	size_t m_lineOffset;
+
+	sl::String m_parserClassName;
+	sl::String m_tokenClassName;
+	sl::String m_symbolVariableName;
+	sl::String m_targetVariableName;
+	const char* m_ppLineFormat;
+
+	size_t m_namedSymbolCount;
+	size_t m_catchSymbolCount;
+	size_t m_laDfaCount;
+
+public:
+	CppGenerator(const CmdLine* cmdLine);
+
+	static
+	CppFrameKind
+	getFrameKind(const sl::StringRef& frame); // frame contents
+
+	bool
+	generate(
+		sl::String* buffer,
+		Module* module,
+		const sl::StringRef& targetFilePath,
+		CppFrameKind frameKind,
+		size_t shardIndex = 0
+	);
+
+protected:
+	void
+	prepare(Module* module);
+
+	sl::String
+	getDefineString(
+		const sl::StringRef& name,
+		const sl::StringRef& defaultValue = sl::StringRef()
+	);
+
+	bool
+	isDefineTrue(
+		const sl::StringRef& name,
+		bool defaultValue
+	);
+
+	bool
+	generateHeader();
+
+	bool
+	generateSource();
+
+	void
+	generateParseTables();
+
+	void
+	generateTokens();
+
+	void
+	generateSymbols();
+
+	bool
+	generateUserCode();
+
+	void
+	generateLaDfas();
+
+	void
+	generateSyncTokenSets();
+
+	void
+	appendLaDfaResolver(
+		LaDfaNode* node,
+		const char* indent
+	);
+
+	// CppParserUtils.lua
+
+	size_t
+	getLine();
+
+	void
+	trimOutput();
+
+	void
+	appendPpLine(
+		const sl::StringRef& filePath,
+		size_t line
+	);
+
+	void
+	appendPpLineDefault() {
+		appendPpLine(m_targetFilePath, getLine() + 1);
+	}
+
+	void
+	appendTokenString(SymbolNode* token);
+
+	void
+	appendTokenInfoString(size_t tokenIndex);
+
+	void
+	appendSymbolDeclaration(
+		SymbolNode* symbol,
+		const sl::StringRef& name,
+		const char* value
+	);
+
+	bool
+	appendUserCode(
+		const sl::StringRef& userCode,
+		DispatcherNode* dispatcher
+	);
+
+	static
+	bool
+	isCustomClass(SymbolNode* symbol) {
+		return
+			!symbol->m_valueBlock.isEmpty() ||
+			!symbol->m_paramBlock.isEmpty() ||
+			!symbol->m_localBlock.isEmpty();
+	}
+
+	static
+	bool
+	hasCreateFunc(SymbolNode* symbol) {
+		return
+			isCustomClass(symbol) ||
+			!symbol->m_enterBlock.isEmpty() ||
+			!symbol->m_leaveBlock.isEmpty();
+	}
+};
+
+//..............................................................................
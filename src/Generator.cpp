@@ -11,21 +11,70 @@
 
 #include "pch.h"
 #include "Generator.h"
+#include "CppGenerator.h"
 #include "Module.h"
+#include "WorkerPool.h"
+
+//..............................................................................
+
+struct GenerateTask {
+	sl::StringRef m_outputFileName;
+	sl::StringRef m_frameFileName;
+	size_t m_shardIndex;
+	bool m_result;
+	err::ErrorRef m_error;
+};
+
+struct GenerateJob {
+	const CmdLine* m_cmdLine;
+	Module* m_module;
+	GenerateTask* m_taskArray;
+	size_t m_taskCount;
+	std::atomic<size_t> m_nextIndex;
+};
+
+static
+void
+runGenerateJob(GenerateJob* job) {
+	Generator generator(job->m_cmdLine);
+	generator.prepare(job->m_module);
+
+	for (;;) {
+		size_t i = job->m_nextIndex++;
+		if (i >= job->m_taskCount)
+			break;
+
+		GenerateTask* task = &job->m_taskArray[i];
+		task->m_result = generator.generate(task->m_outputFileName, task->m_frameFileName, task->m_shardIndex);
+		if (!task->m_result)
+			task->m_error = err::getLastError();
+	}
+}
 
 //..............................................................................
 
 void
 Generator::prepare(Module* module) {
+	m_module = module;
+	m_isLuaPrepared = false;
+}
+
+void
+Generator::prepareLua() {
+	// the grammar is exported to Lua on first use only -- not at all if every
+	// frame is generated natively
+
 	m_stringTemplate.create();
 	m_stringTemplate.m_luaState.setGlobalBoolean("NoPpLine", (m_cmdLine->m_flags & CmdLineFlag_NoPpLine) != 0);
-	module->luaExport(&m_stringTemplate.m_luaState);
+	m_module->luaExport(&m_stringTemplate.m_luaState);
+	m_isLuaPrepared = true;
 }
 
 bool
 Generator::generate(
 	const sl::StringRef& fileName,
-	const sl::StringRef& frameFileName
+	const sl::StringRef& frameFileName,
+	size_t shardIndex
 ) {
 	sl::String frameFilePath;
 	frameFilePath = io::findFilePath(frameFileName, &m_cmdLine->m_frameDirList);
@@ -34,12 +83,10 @@ Generator::generate(
 		return false;
 	}
 
-	bool result;
-
 	io::File targetFile;
 	io::MappedFile frameFile;
 
-	result =
+	bool result =
 		targetFile.open(fileName) &&
 		frameFile.open(frameFilePath, io::FileFlag_ReadOnly);
 
@@ -47,11 +94,43 @@ Generator::generate(
 		return false;
 
 	size_t size = (size_t)frameFile.getSize();
-	char* p = (char*)frameFile.view(0, size);
+	const char* p = (const char*)frameFile.view(0, size);
 	if (!p)
 		return false;
 
-	m_buffer.reserve(size);
+	sl::StringRef frame(p, size);
+
+	CppFrameKind frameKind = (m_cmdLine->m_flags & CmdLineFlag_NativeCpp) ?
+		CppGenerator::getFrameKind(frame) :
+		CppFrameKind_None;
+
+	if (!frameKind)
+		return generateLua(&targetFile, fileName, frameFilePath, frame, shardIndex);
+
+	CppGenerator generator(m_cmdLine);
+	result = generator.generate(&m_buffer, m_module, io::getFullFilePath(fileName), frameKind, shardIndex);
+	if (!result)
+		return false;
+
+	size = m_buffer.getLength();
+
+	return
+		targetFile.write(m_buffer, size) != -1 &&
+		targetFile.setSize(size);
+}
+
+bool
+Generator::generateLua(
+	io::File* targetFile,
+	const sl::StringRef& fileName,
+	const sl::StringRef& frameFilePath,
+	const sl::StringRef& frame,
+	size_t shardIndex
+) {
+	if (!m_isLuaPrepared)
+		prepareLua();
+
+	m_buffer.reserve(frame.getLength());
 
 	sl::String targetFilePath = io::getFullFilePath(fileName);
 	sl::String frameDir = io::getDir(frameFilePath);
@@ -59,16 +138,76 @@ Generator::generate(
 	m_stringTemplate.m_luaState.setGlobalString("TargetFilePath", targetFilePath);
 	m_stringTemplate.m_luaState.setGlobalString("FrameFilePath", frameFilePath);
 	m_stringTemplate.m_luaState.setGlobalString("FrameDir", frameDir);
+	m_stringTemplate.m_luaState.setGlobalInteger("ShardIndex", shardIndex);
 
-	result = m_stringTemplate.process(&m_buffer, frameFilePath, sl::StringRef(p, size));
+	bool result = m_stringTemplate.process(&m_buffer, frameFilePath, frame);
 	if (!result)
 		return false;
 
-	size = m_buffer.getLength();
+	size_t size = m_buffer.getLength();
 
 	return
-		targetFile.write(m_buffer, size) != -1 &&
-		targetFile.setSize(size);
+		targetFile->write(m_buffer, size) != -1 &&
+		targetFile->setSize(size);
+}
+
+//..............................................................................
+
+bool
+generateOutputFiles(
+	const CmdLine* cmdLine,
+	Module* module
+) {
+	ASSERT(cmdLine->m_outputFileNameList.getCount() == cmdLine->m_frameFileNameList.getCount());
+
+	sl::Array<GenerateTask> taskArray;
+	taskArray.setCount(cmdLine->m_outputFileNameList.getCount());
+	sl::Array<GenerateTask>::Rwi rwi = taskArray;
+
+	size_t shardCount = 1;
+
+	sl::BoxIterator<sl::String> outputFileNameIt = cmdLine->m_outputFileNameList.getHead();
+	sl::BoxIterator<sl::String> frameFileNameIt = cmdLine->m_frameFileNameList.getHead();
+	for (size_t i = 0; outputFileNameIt && frameFileNameIt; outputFileNameIt++, frameFileNameIt++, i++) {
+		rwi[i].m_outputFileName = *outputFileNameIt;
+		rwi[i].m_frameFileName = *frameFileNameIt;
+		rwi[i].m_shardIndex = 0;
+		rwi[i].m_result = false;
+
+		for (size_t j = 0; j < i; j++)
+			if (rwi[j].m_frameFileName == rwi[i].m_frameFileName)
+				rwi[i].m_shardIndex++;
+
+		if (rwi[i].m_shardIndex >= shardCount)
+			shardCount = rwi[i].m_shardIndex + 1;
+	}
+
+	size_t count = taskArray.getCount();
+	if (!count)
+		return true;
+
+	if (shardCount > 1)
+		module->buildShardMap(shardCount);
+
+	GenerateJob job;
+	job.m_cmdLine = cmdLine;
+	job.m_module = module;
+	job.m_taskArray = rwi.p();
+	job.m_taskCount = count;
+	job.m_nextIndex = 0;
+
+	size_t threadCount = getWorkerThreadCount(cmdLine->m_jobCount, count);
+	runWorkerPool(threadCount, runGenerateJob, &job);
+
+	// report the first failure in the command line order
+
+	for (size_t i = 0; i < count; i++)
+		if (!taskArray[i].m_result) {
+			err::setError(taskArray[i].m_error);
+			return false;
+		}
+
+	return true;
 }
 
 //..............................................................................
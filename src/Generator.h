@@ -12,28 +12,60 @@
 #pragma once
 
 struct CmdLine;
+class Module;
 
 //..............................................................................
 
 class Generator {
 protected:
 	const CmdLine* m_cmdLine;
+	Module* m_module;
 	st::LuaStringTemplate m_stringTemplate;
 	sl::String m_buffer;
+	bool m_isLuaPrepared;
 
 public:
 	Generator(const CmdLine* cmdLine) {
 		m_cmdLine = cmdLine;
+		m_module = NULL;
+		m_isLuaPrepared = false;
 	}
 
 	void
-	prepare(class Module* module);
+	prepare(Module* module);
 
 	bool
 	generate(
 		const sl::StringRef& fileName,
-		const sl::StringRef& frameFileName
+		const sl::StringRef& frameFileName,
+		size_t shardIndex = 0
+	);
+
+protected:
+	void
+	prepareLua();
+
+	bool
+	generateLua(
+		io::File* targetFile,
+		const sl::StringRef& fileName,
+		const sl::StringRef& frameFilePath,
+		const sl::StringRef& frame,
+		size_t shardIndex
 	);
 };
 
 //..............................................................................
+
+// generates all the output files of the command line; frames are independent
+// of each other, so they are processed by a pool of workers, each with its own
+// generator (and Lua state) over the shared, read-only module. A frame passed
+// more than once is sharded: its N outputs get ShardIndex 0..N-1 (see ShardMap)
+
+bool
+generateOutputFiles(
+	const CmdLine* cmdLine,
+	Module* module
+);
+
+//..............................................................................
@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "LaDfaBuilder.h"
+#include "LaDfaMinimizer.h"
 
 //..............................................................................
 
@@ -19,6 +20,7 @@ LaDfaThread::LaDfaThread() {
 	m_state = NULL;
 	m_production = NULL;
 	m_resolver = NULL;
+	m_stack = NULL;
 }
 
 //..............................................................................
@@ -33,21 +35,27 @@ LaDfaState::LaDfaState() {
 }
 
 LaDfaThread*
-LaDfaState::createThread(LaDfaThread* src) {
-	LaDfaThread* thread = new LaDfaThread;
+LaDfaState::createThread(
+	Arena* arena,
+	LaDfaThread* src
+) {
+	LaDfaThread* thread = new (arena) LaDfaThread;
 	thread->m_state = this;
 
 	if (src) {
-		ASSERT(!src->m_resolver);
-
 		thread->m_production = src->m_production;
-		thread->m_stack = src->m_stack;
+		thread->m_resolver = src->m_resolver; // resolver scans carry on
+		thread->m_stack = src->m_stack; // tails are shared
 	}
 
 	m_activeThreadList.insertTail(thread);
 	return thread;
 }
 
+// a resolver scan in progress keeps the state open even if all threads agree on
+// the production: the scan may still fail, and then the guarded production must
+// not be picked
+
 bool
 LaDfaState::calcResolved() {
 	sl::Iterator<LaDfaThread> thread;
@@ -57,12 +65,15 @@ LaDfaState::calcResolved() {
 		return true;
 	}
 
+	if (m_flags & LaDfaStateFlag_ResolverScan)
+		return false;
+
 	thread = m_activeThreadList.getHead();
 
 	Node* originalProduction = thread->m_production;
 
-	for (thread++; thread; thread++) {
-		if (thread->m_production != originalProduction)
+	for (; thread; thread++) {
+		if (thread->m_resolver || thread->m_production != originalProduction)
 			return false;
 	}
 
@@ -111,13 +122,21 @@ LaDfaState::getDefaultProduction() {
 LaDfaBuilder::LaDfaBuilder(
 	const CmdLine* cmdLine,
 	NodeMgr* nodeMgr,
-	const sl::Array<Node*>* parseTable
+	const ParseTable* parseTable,
+	const sl::Array<size_t>* tokenClassArray,
+	size_t tokenClassCount
 ) {
 	m_cmdLine = cmdLine;
 	m_nodeMgr = nodeMgr;
 	m_parseTable = parseTable;
+	m_tokenClassArray = tokenClassArray;
+	m_tokenClassCount = tokenClassCount;
 	m_conflict = NULL;
-	m_maxUsedLookahead = 1;
+	m_result = NULL;
+	m_threadCount = 0;
+	m_isResolverScanEnabled = false;
+	m_isResolverScanFailed = false;
+	m_isBudgetExceeded = false;
 }
 
 static
@@ -138,74 +157,165 @@ cmpResolverThreadPriority(
 		thread1->m_resolver->m_priority > thread2->m_resolver->m_priority ? -1 : 0;
 }
 
-Node*
-LaDfaBuilder::build(ConflictNode* conflict) {
+// resolvers are first compiled into the lookahead DFA: the resolver symbol is
+// scanned like any other thread, and its production wins once the scan is
+// through. If a resolver turns out to be non-regular (or too big), impure or
+// ambiguous, the conflict is rebuilt with runtime resolvers
+
+bool
+LaDfaBuilder::build(
+	ConflictNode* conflict,
+	LaDfaResult* result
+) {
+	m_isResolverScanEnabled = !(m_cmdLine->m_flags & CmdLineFlag_NoResolverDfa);
+	m_isResolverScanFailed = false;
+
+	bool isOk = buildImpl(conflict, result);
+	if (isOk || !m_isResolverScanFailed)
+		return isOk;
+
+	if (m_cmdLine->m_flags & CmdLineFlag_Verbose)
+		printf(
+			"  RESOLVER scan failed for conflict at %s:%s, using runtime resolvers\n",
+			conflict->m_symbol->m_name.sz(),
+			conflict->m_token->m_name.sz()
+		);
+
+	result->m_resultNode = NULL;
+	result->m_lookahead = 1;
+	result->m_laDfaList.clear();
+	result->m_arena.reset();
+	result->m_usedResolverArray.clear();
+	result->m_scannedResolverArray.clear();
+
+	m_isResolverScanEnabled = false;
+	m_isResolverScanFailed = false;
+	return buildImpl(conflict, result);
+}
+
+bool
+LaDfaBuilder::buildImpl(
+	ConflictNode* conflict,
+	LaDfaResult* result
+) {
 	ASSERT(conflict->m_nodeKind == NodeKind_Conflict);
 
 	m_conflict = conflict;
+	m_result = result;
 
 	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
 
 	m_stateList.clear();
+	m_stateMap.clear();
+	m_arena.reset();
+	m_threadCount = 0;
+	m_isBudgetExceeded = false;
 
 	LaDfaState* state0 = createState();
-	state0->m_dfaNode = m_nodeMgr->createLaDfaNode();
+	state0->m_dfaNode = createLaDfaNode();
 
 	size_t count = conflict->m_productionArray.getCount();
 	for (size_t i = 0; i < count; i++) {
 		GrammarNode* production = conflict->m_productionArray[i];
 
-		LaDfaThread* thread = state0->createThread();
+		LaDfaThread* thread = createThread(state0);
 		thread->m_production = production;
 
 		if (production->m_nodeKind != NodeKind_Epsilon)
-			thread->m_stack.append(production);
+			pushStack(thread, production);
 		else
 			state0->m_flags |= LaDfaStateFlag_EpsilonProduction;
 	}
 
 	LaDfaState* state1;
-	bool result = transition(&state1, state0, conflict->m_token);
-	if (!result) {
-		err::setFormatStringError(
-			"conflict at %s:%s causes depth overflow, check for left recursion",
-			conflict->m_symbol->m_name.sz(),
-			conflict->m_token->m_name.sz()
-		);
-
-		lex::pushSrcPosError(conflict->m_symbol->m_srcPos);
-		return NULL;
-	}
+	bool isOk = transition(&state1, state0, conflict->m_token);
+	if (!isOk)
+		return failTransition(state0);
 
 	size_t lookahead = 1;
 
 	if (!state1->isResolved()) {
+		// in LL(*) mode, repeating configurations loop back to existing states,
+		// so the DFA may turn cyclic -- it is bounded by the state count instead
+
+		bool isLlStar = (m_cmdLine->m_flags & CmdLineFlag_LlStar) != 0;
+
+		// in auto mode, annotations are ignored -- BFS stops at the minimal k anyway
+
+		size_t lookaheadLimit = m_cmdLine->m_autoLookaheadLimit ?
+			m_cmdLine->m_autoLookaheadLimit :
+			conflict->m_symbol->m_lookaheadLimit;
+
 		sl::Array<LaDfaState*> stateArray;
 		stateArray.append(state1);
 
-		while (!stateArray.isEmpty() && lookahead < conflict->m_symbol->m_lookaheadLimit) {
-			lookahead++;
+		LaDfaState* unresolvedState = NULL;
 
+		while (!stateArray.isEmpty()) {
 			sl::Array<LaDfaState*> nextStateArray;
 
 			size_t stateCount = stateArray.getCount();
 			for (size_t j = 0; j < stateCount; j++) {
 				LaDfaState* state = stateArray[j];
 
+				if (m_stateList.getCount() > m_cmdLine->m_laDfaStateLimit ||
+					m_threadCount > m_cmdLine->m_laDfaThreadLimit) {
+					failBudget();
+					return failTransition(state);
+				}
+
+				// resolver scans go past the lookahead limit
+
+				bool isScan = (state->m_flags & LaDfaStateFlag_ResolverScan) != 0;
+				if (!isLlStar && !isScan && lookahead >= lookaheadLimit) {
+					unresolvedState = state;
+					break;
+				}
+
+				sl::BitMap liveTokenSet;
+				bool isLimited = calcLiveTokenSet(&liveTokenSet, state);
+
+				// tokens of the same class take the same path through the parse
+				// table; unless some thread compares a token with a token node
+				// right away, the whole class moves to where its first token went
+
+				sl::BitMap directTokenSet;
+				calcDirectTokenSet(&directTokenSet, state);
+
+				sl::BitMap classDoneSet;
+				classDoneSet.setBitCount(m_tokenClassCount);
+
+				sl::Array<LaDfaState*> classTargetArray;
+				classTargetArray.setCountZeroConstruct(m_tokenClassCount);
+				sl::Array<LaDfaState*>::Rwi classTargetRwi = classTargetArray;
+
 				for (size_t k = 0; k < tokenCount; k++) {
+					if (isLimited && !liveTokenSet.getBit(k)) // would yield an empty state
+						continue;
+
 					SymbolNode* token = m_nodeMgr->m_tokenArray[k];
+					size_t tokenClass = (*m_tokenClassArray)[k];
+					bool isClassShared = k >= 2 && !directTokenSet.getBit(k); // EOF & anytoken are special
+
+					if (isClassShared && classDoneSet.getBit(tokenClass)) {
+						if (classTargetRwi[tokenClass])
+							addTransition(state, token, classTargetRwi[tokenClass]);
+
+						continue;
+					}
+
+					size_t transitionCount = state->m_transitionArray.getCount();
 
 					LaDfaState* newState;
-					result = transition(&newState, state, token);
-					if (!result) {
-						err::setFormatStringError(
-							"conflict at %s:%s causes depth overflow, check for left recursion",
-							conflict->m_symbol->m_name.sz(),
-							conflict->m_token->m_name.sz()
-						);
-
-						lex::pushSrcPosError(conflict->m_symbol->m_srcPos);
-						return NULL;
+					isOk = transition(&newState, state, token);
+					if (!isOk)
+						return failTransition(state);
+
+					if (isClassShared) {
+						classDoneSet.setBit(tokenClass);
+						classTargetRwi[tokenClass] = state->m_transitionArray.getCount() > transitionCount ?
+							state->m_transitionArray.getBack().m_state :
+							NULL;
 					}
 
 					if (newState && !newState->isResolved())
@@ -213,38 +323,28 @@ LaDfaBuilder::build(ConflictNode* conflict) {
 				}
 			}
 
+			if (unresolvedState)
+				break;
+
+			lookahead++;
 			stateArray = nextStateArray;
 		}
 
-		if (!stateArray.isEmpty()) {
-			LaDfaState* state = stateArray[0];
-			sl::BoxList<sl::String> tokenNameList;
-
-			for (; state != state0; state = state->m_fromState)
-				tokenNameList.insertHead(state->m_token->m_name);
-
-			sl::String tokenSeqString;
-			sl::BoxIterator<sl::String> tokenName = tokenNameList.getHead();
-			for (; tokenName; tokenName++) {
-				tokenSeqString.append(*tokenName);
-				tokenSeqString.append(' ');
-			}
-
+		if (unresolvedState) {
 			err::setFormatStringError(
 				"conflict at %s:%s could not be resolved with %d token lookahead; e.g. %s",
 				conflict->m_symbol->m_name.sz(),
 				conflict->m_token->m_name.sz(),
-				conflict->m_symbol->m_lookaheadLimit,
-				tokenSeqString.sz()
+				lookaheadLimit,
+				getTokenSeqString(unresolvedState).sz()
 			);
 
 			lex::pushSrcPosError(conflict->m_symbol->m_srcPos);
-			return NULL;
+			return false;
 		}
 	}
 
-	if (lookahead > m_maxUsedLookahead)
-		m_maxUsedLookahead = lookahead;
+	result->m_lookahead = lookahead;
 
 	sl::Iterator<LaDfaState> it = m_stateList.getHead();
 	for (; it; it++) {
@@ -259,7 +359,7 @@ LaDfaBuilder::build(ConflictNode* conflict) {
 				state->m_token->m_name.sz()
 			);
 			lex::pushSrcPosError(conflict->m_symbol->m_srcPos);
-			return NULL;
+			return false;
 		}
 
 		if (!state->m_resolverThreadList.isEmpty()) { // chain all resolvers
@@ -278,7 +378,7 @@ LaDfaBuilder::build(ConflictNode* conflict) {
 			for (size_t i = 0; i < count; i++) {
 				LaDfaThread* resolverThread = resolverThreadArray[i];
 
-				LaDfaNode* dfaElse = m_nodeMgr->createLaDfaNode();
+				LaDfaNode* dfaElse = createLaDfaNode();
 				dfaElse->m_flags = state->m_dfaNode->m_flags;
 				dfaElse->m_transitionArray = state->m_dfaNode->m_transitionArray;
 
@@ -314,7 +414,7 @@ LaDfaBuilder::build(ConflictNode* conflict) {
 					uplink->m_resolver = NULL;
 					uplink->m_resolverElse = NULL;
 
-					m_nodeMgr->deleteLaDfaNode(state->m_dfaNode);
+					deleteLaDfaNode(state->m_dfaNode);
 					state->m_dfaNode = uplink;
 				}
 			}
@@ -331,10 +431,61 @@ LaDfaBuilder::build(ConflictNode* conflict) {
 		// can happen on active-vs-complete-vs-epsion conflicts
 
 		state0->m_dfaNode->m_flags |= LaDfaNodeFlag_Leaf; // don't index state0
-		return state1->m_dfaNode->m_production;
+		result->m_resultNode = state1->m_dfaNode->m_production;
+	} else {
+		minimize(state0);
+	}
+
+	return true;
+}
+
+// the builder stopped at the state; sets the error unless the conflict is about
+// to be rebuilt with runtime resolvers
+
+bool
+LaDfaBuilder::failTransition(LaDfaState* state) {
+	if (m_isResolverScanFailed)
+		return false;
+
+	if (m_isBudgetExceeded)
+		err::setFormatStringError(
+			"conflict at %s:%s exceeds the lookahead DFA budget at %d token lookahead "
+			"(%d states, %d threads; limits are %d and %d); e.g. %s",
+			m_conflict->m_symbol->m_name.sz(),
+			m_conflict->m_token->m_name.sz(),
+			state->m_lookahead + 1,
+			m_stateList.getCount(),
+			m_threadCount,
+			m_cmdLine->m_laDfaStateLimit,
+			m_cmdLine->m_laDfaThreadLimit,
+			getTokenSeqString(state).sz()
+		);
+	else
+		err::setFormatStringError(
+			"conflict at %s:%s causes depth overflow, check for left recursion",
+			m_conflict->m_symbol->m_name.sz(),
+			m_conflict->m_token->m_name.sz()
+		);
+
+	lex::pushSrcPosError(m_conflict->m_symbol->m_srcPos);
+	return false;
+}
+
+sl::String
+LaDfaBuilder::getTokenSeqString(LaDfaState* state) {
+	sl::BoxList<sl::String> tokenNameList;
+
+	for (; state->m_fromState; state = state->m_fromState)
+		tokenNameList.insertHead(state->m_token->m_name);
+
+	sl::String tokenSeqString;
+	sl::BoxIterator<sl::String> tokenName = tokenNameList.getHead();
+	for (; tokenName; tokenName++) {
+		tokenSeqString.append(*tokenName);
+		tokenSeqString.append(' ');
 	}
 
-	return state0->m_dfaNode;
+	return tokenSeqString;
 }
 
 void
@@ -398,26 +549,239 @@ LaDfaBuilder::trace() {
 		if (!state->isResolved()) {
 			size_t moveCount = state->m_transitionArray.getCount();
 			for (size_t i = 0; i < moveCount; i++) {
-				LaDfaState* moveTo = state->m_transitionArray[i];
+				const LaDfaStateTransition& move = state->m_transitionArray[i];
 				printf(
 					"\t%s -> %d\n",
-					moveTo->m_token->m_name.sz(),
-					moveTo->m_index
+					move.m_token->m_name.sz(),
+					move.m_state->m_index
 				);
 			}
 		}
 	}
 }
 
+// collects tokens which can advance at least one active thread of the state;
+// returns false if any token could (a thread may complete without a match or
+// wait for anytoken)
+
+bool
+LaDfaBuilder::calcLiveTokenSet(
+	sl::BitMap* tokenSet,
+	LaDfaState* state
+) {
+	tokenSet->setBitCount(m_nodeMgr->m_tokenArray.getCount());
+
+	sl::Iterator<LaDfaThread> threadIt = state->m_activeThreadList.getHead();
+	for (; threadIt; threadIt++) {
+		LaDfaStackEntry* entry = threadIt->m_stack;
+		for (; entry; entry = entry->m_next) {
+			bool isNullable = mergeFirstSet(tokenSet, entry->m_node);
+			if (!isNullable)
+				break;
+		}
+
+		if (!entry)
+			return false;
+	}
+
+	return !tokenSet->getBit(1);
+}
+
+bool
+LaDfaBuilder::mergeFirstSet(
+	sl::BitMap* tokenSet,
+	Node* node
+) {
+	if (node->m_nodeKind != NodeKind_Conflict) {
+		GrammarNode* grammarNode = (GrammarNode*)node;
+		tokenSet->mergeCmp<sl::BitMapOr>(grammarNode->m_firstSet);
+		return grammarNode->isNullable();
+	}
+
+	ConflictNode* conflict = (ConflictNode*)node;
+	bool isNullable = false;
+
+	size_t count = conflict->m_productionArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		GrammarNode* production = conflict->m_productionArray[i];
+		tokenSet->mergeCmp<sl::BitMapOr>(production->m_firstSet);
+		if (production->isNullable())
+			isNullable = true;
+	}
+
+	return isNullable;
+}
+
+// collects tokens which a thread of the state may compare with a token node
+// before (or without) looking up the parse table: the stack continuation left
+// behind by the previous step. The parse table can't tell these apart from the
+// other tokens of their class
+
+void
+LaDfaBuilder::calcDirectTokenSet(
+	sl::BitMap* tokenSet,
+	LaDfaState* state
+) {
+	tokenSet->setBitCount(m_nodeMgr->m_tokenArray.getCount());
+
+	sl::Iterator<LaDfaThread> threadIt = state->m_activeThreadList.getHead();
+	for (; threadIt; threadIt++) {
+		LaDfaStackEntry* entry = threadIt->m_stack;
+		for (; entry; entry = entry->m_next) {
+			bool isNullable = mergeDirectTokenSet(tokenSet, entry->m_node);
+			if (!isNullable)
+				break;
+		}
+	}
+}
+
+bool
+LaDfaBuilder::mergeDirectTokenSet(
+	sl::BitMap* tokenSet,
+	Node* node
+) {
+	SequenceNode* sequence;
+	ConflictNode* conflict;
+	size_t count;
+	bool isNullable;
+
+	switch (node->m_nodeKind) {
+	case NodeKind_Token:
+		tokenSet->setBit(node->m_index);
+		return false;
+
+	case NodeKind_Symbol: // productions are picked by the parse table
+		return ((GrammarNode*)node)->isNullable();
+
+	case NodeKind_Sequence:
+		sequence = (SequenceNode*)node;
+		count = sequence->m_sequence.getCount();
+		for (size_t i = 0; i < count; i++) {
+			isNullable = mergeDirectTokenSet(tokenSet, sequence->m_sequence[i]);
+			if (!isNullable)
+				return false;
+		}
+
+		return true;
+
+	case NodeKind_Beacon:
+		return mergeDirectTokenSet(tokenSet, ((BeaconNode*)node)->m_target);
+
+	case NodeKind_Conflict:
+		conflict = (ConflictNode*)node;
+		isNullable = false;
+
+		count = conflict->m_productionArray.getCount();
+		for (size_t i = 0; i < count; i++)
+			if (mergeDirectTokenSet(tokenSet, conflict->m_productionArray[i]))
+				isNullable = true;
+
+		return isNullable;
+
+	default: // epsilon, actions & arguments
+		return true;
+	}
+}
+
 LaDfaState*
 LaDfaBuilder::createState() {
-	LaDfaState* state = new LaDfaState;
+	LaDfaState* state = new (&m_arena) LaDfaState;
 	state->m_index = m_stateList.getCount();
 	m_stateList.insertTail(state);
 
 	return state;
 }
 
+void
+LaDfaBuilder::addTransition(
+	LaDfaState* state,
+	SymbolNode* token,
+	LaDfaState* targetState
+) {
+	LaDfaStateTransition stateTransition = { token, targetState };
+	LaDfaTransition transition = { token, targetState->m_dfaNode };
+	state->m_transitionArray.append(stateTransition);
+	state->m_dfaNode->m_transitionArray.append(transition);
+}
+
+// states with the same signature have the same future, whichever token path
+// led to them: same lookahead, flags, inherited default and thread stacks
+// (thread order is kept -- it decides between productions on ties). In LL(*)
+// mode and during resolver scans the lookahead is left out: resolvers are only
+// picked up at the first step, so any two states past it behave the same
+// regardless of depth
+
+void
+LaDfaBuilder::getStateSignature(
+	sl::String* signature,
+	LaDfaState* state
+) {
+	signature->format(
+		"%d %x %p",
+		(m_cmdLine->m_flags & CmdLineFlag_LlStar) || (state->m_flags & LaDfaStateFlag_ResolverScan) ?
+			0 :
+			state->m_lookahead,
+		state->m_flags,
+		state->getDefaultProduction()
+	);
+
+	appendThreadListSignature(signature, 'a', &state->m_activeThreadList);
+	appendThreadListSignature(signature, 'r', &state->m_resolverThreadList);
+	appendThreadListSignature(signature, 'c', &state->m_completeThreadList);
+	appendThreadListSignature(signature, 'e', &state->m_epsilonThreadList);
+}
+
+void
+LaDfaBuilder::appendThreadListSignature(
+	sl::String* signature,
+	char listKind,
+	sl::List<LaDfaThread>* list
+) {
+	signature->appendFormat(" %c", listKind);
+
+	sl::Iterator<LaDfaThread> threadIt = list->getHead();
+	for (; threadIt; threadIt++) {
+		LaDfaThread* thread = *threadIt;
+		signature->appendFormat(
+			" %p/%p/%d:",
+			thread->m_production,
+			thread->m_resolver,
+			thread->m_match
+		);
+
+		LaDfaStackEntry* entry = thread->m_stack;
+		for (; entry; entry = entry->m_next)
+			signature->appendFormat(" %p", entry->m_node);
+
+		signature->append(';');
+	}
+}
+
+// merges equivalent nodes of the finished DFA; node ordinals are renumbered so
+// that NodeMgr::addLaDfaNodes() names stay dense
+
+void
+LaDfaBuilder::minimize(LaDfaState* state0) {
+	LaDfaMinimizer minimizer;
+	size_t duplicateCount = minimizer.calcEquivalence(&m_result->m_laDfaList);
+	m_result->m_resultNode = minimizer.getRepresentative(state0->m_dfaNode);
+	minimizer.removeDuplicates(&m_result->m_laDfaList);
+	if (!duplicateCount)
+		return;
+
+	sl::Iterator<LaDfaNode> nodeIt = m_result->m_laDfaList.getHead();
+	for (size_t i = 0; nodeIt; nodeIt++, i++)
+		nodeIt->m_index = i;
+}
+
+LaDfaNode*
+LaDfaBuilder::createLaDfaNode() {
+	LaDfaNode* node = new (&m_result->m_arena) LaDfaNode;
+	node->m_index = m_result->m_laDfaList.getCount(); // named in NodeMgr::addLaDfaNodes()
+	m_result->m_laDfaList.insertTail(node);
+	return node;
+}
+
 bool
 LaDfaBuilder::transition(
 	LaDfaState** resultState,
@@ -434,7 +798,7 @@ LaDfaBuilder::transition(
 
 	sl::Iterator<LaDfaThread> threadIt = state->m_activeThreadList.getHead();
 	for (; threadIt; threadIt++) {
-		LaDfaThread* newThread = newState->createThread(*threadIt);
+		LaDfaThread* newThread = createThread(newState, *threadIt);
 		result = processThread(newThread, 0);
 		if (!result)
 			return false;
@@ -446,7 +810,7 @@ LaDfaBuilder::transition(
 
 		if (thread->m_match == LaDfaThreadMatchKind_AnyToken && newState->isAnyTokenIgnored()) {
 			newState->m_activeThreadList.erase(thread); // delete anytoken thread in favor of concrete token
-		} else if (thread->m_stack.isEmpty()) {
+		} else if (!thread->m_stack) {
 			newState->m_activeThreadList.remove(thread);
 
 			if (thread->m_match)
@@ -456,18 +820,35 @@ LaDfaBuilder::transition(
 		}
 	}
 
+	if (m_isResolverScanEnabled) {
+		result = finalizeResolverScans(newState);
+		if (!result)
+			return false;
+	}
+
 	if (newState->isEmpty()) {
 		m_stateList.erase(newState);
 		*resultState = NULL;
 		return true;
 	}
 
-	newState->m_dfaNode = m_nodeMgr->createLaDfaNode();
-	newState->m_dfaNode->m_token = token;
+	sl::String signature;
+	getStateSignature(&signature, newState);
+
+	sl::StringHashTableIterator<LaDfaState*> it = m_stateMap.visit(signature);
+	if (it->m_value) { // already reached on another token path
+		m_stateList.erase(newState);
+		addTransition(state, token, it->m_value);
+		*resultState = NULL;
+		return true;
+	}
+
+	it->m_value = newState;
+
+	newState->m_dfaNode = createLaDfaNode();
 	newState->calcResolved();
 
-	state->m_dfaNode->m_transitionArray.append(newState->m_dfaNode);
-	state->m_transitionArray.append(newState);
+	addTransition(state, token, newState);
 	*resultState = newState;
 
 	return true;
@@ -485,12 +866,11 @@ LaDfaBuilder::processThread(
 
 	thread->m_match = LaDfaThreadMatchKind_None;
 
-	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
 	for (;;) {
-		if (thread->m_stack.isEmpty())
+		if (!thread->m_stack)
 			break;
 
-		Node* node = thread->m_stack.getBack();
+		Node* node = thread->m_stack->m_node;
 		Node* production;
 		SymbolNode* symbol;
 		ConflictNode* conflict;
@@ -505,7 +885,10 @@ LaDfaBuilder::processThread(
 			ASSERT(node->m_masterIndex);
 
 			if ((node->m_flags & SymbolNodeFlag_AnyToken) && token->m_masterIndex != 0) { // EOF does not match ANY
-				thread->m_stack.pop();
+				if (thread->m_resolver) // anytoken threads may get discarded in favor of concrete tokens
+					return failResolverScan();
+
+				popStack(thread);
 				thread->m_match = LaDfaThreadMatchKind_AnyToken;
 				break;
 			}
@@ -515,44 +898,71 @@ LaDfaBuilder::processThread(
 				return true;
 			}
 
-			thread->m_stack.pop();
+			popStack(thread);
 			thread->m_match = LaDfaThreadMatchKind_Token;
-			thread->m_state->m_flags |= LaDfaStateFlag_TokenMatch;
+
+			if (!thread->m_resolver) // resolver scans must not affect the other threads
+				thread->m_state->m_flags |= LaDfaStateFlag_TokenMatch;
+
 			break;
 
 		case NodeKind_Symbol:
 			if (thread->m_match)
 				return true;
 
-			production = (*m_parseTable)[node->m_index * tokenCount + token->m_index];
+			production = m_parseTable->get(node->m_index, token->m_index);
 			if (!production) { // could happen after epsilon production
 				thread->m_state->m_activeThreadList.erase(thread);
 				return true;
 			}
 
+			if (thread->m_resolver) {
+				// inside a resolver scan, the runtime parser would not go through
+				// conflicts, so there is no reason to look at nested resolvers
+
+				if (production->m_nodeKind == NodeKind_Conflict)
+					return failResolverScan();
+
+				popStack(thread);
+
+				if (production->m_nodeKind != NodeKind_Epsilon)
+					pushStack(thread, production);
+
+				break;
+			}
+
 			// ok this thread seems to stay active, let's check if we can eliminate it with resolver
 
 			symbol = (SymbolNode*)node;
 			if (symbol->m_resolver && thread->m_state->m_lookahead == 1) { // only use resolvers at the first step
 				if (m_cmdLine->m_flags & CmdLineFlag_Verbose)
 					printf(
-						"  RESOLVER of %s is used for conflict at %s:%s\n",
+						"  RESOLVER of %s is %s for conflict at %s:%s\n",
 						symbol->m_name.sz(),
+						m_isResolverScanEnabled ? "scanned" : "used",
 						m_conflict->m_symbol->m_name.sz(),
 						m_conflict->m_token->m_name.sz()
 					);
 
-				symbol->m_resolver->m_flags |= SymbolNodeFlag_ResolverUsed;
 				thread->m_resolver = symbol->m_resolver;
+
+				if (m_isResolverScanEnabled) { // replace the stack with the resolver and go on
+					m_result->m_scannedResolverArray.append(symbol->m_resolver); // flagged on merge
+					thread->m_stack = NULL;
+					pushStack(thread, symbol->m_resolver);
+					break;
+				}
+
+				m_result->m_usedResolverArray.append(symbol->m_resolver); // flagged on merge
 				thread->m_state->m_activeThreadList.remove(thread);
 				thread->m_state->m_resolverThreadList.insertTail(thread);
 				return true;
 			}
 
-			thread->m_stack.pop();
+			popStack(thread);
 
 			if (production->m_nodeKind != NodeKind_Epsilon)
-				thread->m_stack.append(production);
+				pushStack(thread, production);
 			else
 				thread->m_state->m_flags |= LaDfaStateFlag_EpsilonProduction;
 
@@ -562,39 +972,48 @@ LaDfaBuilder::processThread(
 			if (thread->m_match)
 				return true;
 
-			thread->m_stack.pop();
+			popStack(thread);
 
 			sequence = (SequenceNode*)node;
 			childrenCount = sequence->m_sequence.getCount();
 			for (intptr_t i = childrenCount - 1; i >= 0; i--) {
 				Node* child = sequence->m_sequence[i];
-				thread->m_stack.append(child);
+				pushStack(thread, child);
 			}
 
 			break;
 
 		case NodeKind_Beacon:
-			thread->m_stack.pop();
-			thread->m_stack.append(((BeaconNode*)node)->m_target);
+			popStack(thread);
+			pushStack(thread, ((BeaconNode*)node)->m_target);
 			break;
 
 		case NodeKind_Action:
 		case NodeKind_Argument:
-			thread->m_stack.pop();
+			if (thread->m_resolver) // user code may have side effects or fail the resolver
+				return failResolverScan();
+
+			popStack(thread);
 			break;
 
 		case NodeKind_Conflict:
-			thread->m_stack.pop();
+			if (thread->m_resolver)
+				return failResolverScan();
+
+			popStack(thread);
 
 			conflict = (ConflictNode*)node;
 			childrenCount = conflict->m_productionArray.getCount();
+			if (m_threadCount + childrenCount > m_cmdLine->m_laDfaThreadLimit)
+				return failBudget();
+
 			depth++;
 			for (size_t i = 0; i < childrenCount; i++) {
 				Node* child = conflict->m_productionArray[i];
-				LaDfaThread* newThread = thread->m_state->createThread(thread);
+				LaDfaThread* newThread = createThread(thread->m_state, thread);
 
 				if (child->m_nodeKind != NodeKind_Epsilon)
-					newThread->m_stack.append(child);
+					pushStack(newThread, child);
 
 				bool result = processThread(newThread, depth);
 				if (!result)
@@ -612,4 +1031,54 @@ LaDfaBuilder::processThread(
 	return true;
 }
 
+LaDfaThread*
+LaDfaBuilder::findResolverScan(sl::List<LaDfaThread>* list) {
+	LaDfaThread* result = NULL;
+
+	sl::Iterator<LaDfaThread> threadIt = list->getHead();
+	for (; threadIt; threadIt++) {
+		LaDfaThread* thread = *threadIt;
+		if (thread->m_resolver && (!result || thread->m_resolver->m_priority > result->m_resolver->m_priority))
+			result = thread;
+	}
+
+	return result;
+}
+
+// a finished scan means its resolver would succeed at runtime, so the state is
+// resolved to the scanned production -- unless a resolver of the same or higher
+// priority is still being scanned (we can't tell the order they run in)
+
+bool
+LaDfaBuilder::finalizeResolverScans(LaDfaState* state) {
+	LaDfaThread* activeScan = findResolverScan(&state->m_activeThreadList);
+	LaDfaThread* completeScan = findResolverScan(&state->m_completeThreadList);
+	LaDfaThread* epsilonScan = findResolverScan(&state->m_epsilonThreadList);
+
+	if (!completeScan ||
+		epsilonScan && epsilonScan->m_resolver->m_priority > completeScan->m_resolver->m_priority)
+		completeScan = epsilonScan;
+
+	if (!completeScan) {
+		if (activeScan)
+			state->m_flags |= LaDfaStateFlag_ResolverScan;
+
+		return true;
+	}
+
+	if (activeScan && activeScan->m_resolver->m_priority >= completeScan->m_resolver->m_priority)
+		return failResolverScan();
+
+	if (completeScan == epsilonScan)
+		state->m_epsilonThreadList.remove(completeScan);
+	else
+		state->m_completeThreadList.remove(completeScan);
+
+	state->m_activeThreadList.clear();
+	state->m_completeThreadList.clear();
+	state->m_epsilonThreadList.clear();
+	state->m_completeThreadList.insertTail(completeScan);
+	return true;
+}
+
 //..............................................................................
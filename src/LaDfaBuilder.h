@@ -12,6 +12,7 @@
 #pragma once
 
 #include "NodeMgr.h"
+#include "ParseTable.h"
 #include "CmdLine.h"
 
 class LaDfaState;
@@ -26,13 +27,28 @@ enum LaDfaThreadMatchKind {
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-class LaDfaThread: public sl::ListLink {
+// thread stacks are immutable cons lists with shared tails -- forking a thread
+// only copies the top pointer
+
+struct LaDfaStackEntry {
+	Node* m_node;
+	LaDfaStackEntry* m_next;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// states, threads and stack entries live in the builder's arena and all die
+// with the builder run
+
+class LaDfaThread:
+	public sl::ListLink,
+	public ArenaObject {
 public:
 	LaDfaThreadMatchKind m_match;
 	LaDfaState* m_state;
-	SymbolNode* m_resolver;
+	SymbolNode* m_resolver; // on an active thread: the resolver is being scanned
 	Node* m_production;
-	sl::Array<Node*> m_stack;
+	LaDfaStackEntry* m_stack; // top of the stack
 
 public:
 	LaDfaThread();
@@ -40,14 +56,24 @@ public:
 
 //..............................................................................
 
+struct LaDfaStateTransition {
+	SymbolNode* m_token;
+	LaDfaState* m_state;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 enum LaDfaStateFlag {
 	LaDfaStateFlag_TokenMatch        = 1,
 	LaDfaStateFlag_EpsilonProduction = 2,
+	LaDfaStateFlag_ResolverScan      = 4,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-class LaDfaState: public sl::ListLink {
+class LaDfaState:
+	public sl::ListLink,
+	public ArenaObject {
 public:
 	size_t m_index;
 	size_t m_lookahead;
@@ -60,7 +86,7 @@ public:
 
 	LaDfaState* m_fromState;
 	SymbolNode* m_token;
-	sl::Array<LaDfaState*> m_transitionArray;
+	sl::Array<LaDfaStateTransition> m_transitionArray;
 	LaDfaNode* m_dfaNode;
 
 public:
@@ -89,7 +115,10 @@ public:
 	calcResolved();
 
 	LaDfaThread*
-	createThread(LaDfaThread* src = NULL);
+	createThread(
+		Arena* arena,
+		LaDfaThread* src = NULL
+	);
 
 	Node*
 	getResolvedProduction();
@@ -100,37 +129,159 @@ public:
 
 //..............................................................................
 
+// everything a builder produces for a single conflict; conflicts can be resolved
+// concurrently, so results are merged into the NodeMgr in the conflict order
+
+class LaDfaResult: public sl::ListLink {
+public:
+	Node* m_resultNode; // lookahead DFA or immediate production
+	size_t m_lookahead;
+	Arena m_arena; // taken over by the NodeMgr on merge
+	sl::List<LaDfaNode> m_laDfaList;
+	sl::Array<SymbolNode*> m_usedResolverArray; // tried at runtime
+	sl::Array<SymbolNode*> m_scannedResolverArray; // compiled into the DFA
+	err::ErrorRef m_error;
+
+public:
+	LaDfaResult() {
+		m_resultNode = NULL;
+		m_lookahead = 1;
+	}
+};
+
+//..............................................................................
+
 class LaDfaBuilder {
 protected:
 	const CmdLine* m_cmdLine;
 	NodeMgr* m_nodeMgr;
+	Arena m_arena;
 	sl::List<LaDfaState> m_stateList;
-	const sl::Array<Node*>* m_parseTable;
+	sl::StringHashTable<LaDfaState*> m_stateMap; // signature -> state
+	const ParseTable* m_parseTable;
+	const sl::Array<size_t>* m_tokenClassArray; // token index -> class
+	size_t m_tokenClassCount;
 	ConflictNode* m_conflict;
-	size_t m_maxUsedLookahead;
+	LaDfaResult* m_result;
+	size_t m_threadCount;
+	bool m_isResolverScanEnabled;
+	bool m_isResolverScanFailed;
+	bool m_isBudgetExceeded;
 
 public:
 	LaDfaBuilder(
 		const CmdLine* cmdLine,
 		NodeMgr* nodeMgr,
-		const sl::Array<Node*>* parseTable
+		const ParseTable* parseTable,
+		const sl::Array<size_t>* tokenClassArray,
+		size_t tokenClassCount
 	);
 
-	Node*
-	build(ConflictNode* conflict); // returns DFA or immediate production
+	bool
+	build(
+		ConflictNode* conflict,
+		LaDfaResult* result
+	);
 
 	void
 	trace();
 
-	size_t
-	getMaxUsedLookahead() {
-		return m_maxUsedLookahead;
-	}
-
 protected:
+	bool
+	buildImpl(
+		ConflictNode* conflict,
+		LaDfaResult* result
+	);
+
 	LaDfaState*
 	createState();
 
+	LaDfaThread*
+	createThread(
+		LaDfaState* state,
+		LaDfaThread* src = NULL
+	) {
+		m_threadCount++;
+		return state->createThread(&m_arena, src);
+	}
+
+	static
+	void
+	addTransition(
+		LaDfaState* state,
+		SymbolNode* token,
+		LaDfaState* targetState
+	);
+
+	void
+	getStateSignature(
+		sl::String* signature,
+		LaDfaState* state
+	);
+
+	static
+	void
+	appendThreadListSignature(
+		sl::String* signature,
+		char listKind,
+		sl::List<LaDfaThread>* list
+	);
+
+	void
+	minimize(LaDfaState* state0);
+
+	bool
+	calcLiveTokenSet(
+		sl::BitMap* tokenSet,
+		LaDfaState* state
+	);
+
+	static
+	bool
+	mergeFirstSet(
+		sl::BitMap* tokenSet,
+		Node* node
+	); // returns true if nullable
+
+	void
+	calcDirectTokenSet(
+		sl::BitMap* tokenSet,
+		LaDfaState* state
+	);
+
+	static
+	bool
+	mergeDirectTokenSet(
+		sl::BitMap* tokenSet,
+		Node* node
+	); // returns true if nullable
+
+	LaDfaNode*
+	createLaDfaNode();
+
+	void
+	pushStack(
+		LaDfaThread* thread,
+		Node* node
+	) {
+		LaDfaStackEntry* entry = (LaDfaStackEntry*)m_arena.allocate(sizeof(LaDfaStackEntry));
+		entry->m_node = node;
+		entry->m_next = thread->m_stack;
+		thread->m_stack = entry;
+	}
+
+	static
+	void
+	popStack(LaDfaThread* thread) {
+		ASSERT(thread->m_stack);
+		thread->m_stack = thread->m_stack->m_next;
+	}
+
+	void
+	deleteLaDfaNode(LaDfaNode* node) {
+		m_result->m_laDfaList.erase(node);
+	}
+
 	bool
 	transition(
 		LaDfaState** resultState,
@@ -143,6 +294,36 @@ protected:
 		LaDfaThread* thread,
 		size_t depth
 	);
+
+	bool
+	failResolverScan() {
+		m_isResolverScanFailed = true;
+		return false;
+	}
+
+	bool
+	failBudget() {
+		if (m_isResolverScanEnabled && !m_result->m_scannedResolverArray.isEmpty())
+			m_isResolverScanFailed = true; // maybe runtime resolvers will do
+		else
+			m_isBudgetExceeded = true;
+
+		return false;
+	}
+
+	bool
+	failTransition(LaDfaState* state);
+
+	static
+	sl::String
+	getTokenSeqString(LaDfaState* state);
+
+	static
+	LaDfaThread*
+	findResolverScan(sl::List<LaDfaThread>* list);
+
+	bool
+	finalizeResolverScans(LaDfaState* state);
 };
 
 //..............................................................................
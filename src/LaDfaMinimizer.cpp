@@ -0,0 +1,106 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "LaDfaMinimizer.h"
+
+//..............................................................................
+
+size_t
+LaDfaMinimizer::calcEquivalence(sl::List<LaDfaNode>* list) {
+	size_t count = list->getCount();
+	m_nodeArray.setCount(count);
+
+	// LaDfa nodes are not indexed yet, so master indices are free to hold positions
+
+	sl::Array<LaDfaNode*>::Rwi nodeRwi = m_nodeArray;
+	sl::Iterator<LaDfaNode> nodeIt = list->getHead();
+	for (size_t i = 0; nodeIt; nodeIt++, i++) {
+		LaDfaNode* node = *nodeIt;
+		ASSERT(node->m_masterIndex == -1);
+		node->m_masterIndex = i;
+		nodeRwi[i] = node;
+	}
+
+	refine();
+
+	return count - m_representativeArray.getCount();
+}
+
+Node*
+LaDfaMinimizer::getRepresentative(Node* node) {
+	return node && node->m_nodeKind == NodeKind_LaDfa ?
+		m_representativeArray[getClass(node)] :
+		node;
+}
+
+void
+LaDfaMinimizer::removeDuplicates(sl::List<LaDfaNode>* list) {
+	size_t count = m_nodeArray.getCount();
+	ASSERT(list->getCount() == count);
+
+	for (size_t i = 0; i < count; i++) {
+		LaDfaNode* node = m_nodeArray[i];
+		if (m_representativeArray[m_classArray[i]] != node)
+			continue;
+
+		node->m_resolverElse = getRepresentative(node->m_resolverElse);
+		node->m_resolverUplink = (LaDfaNode*)getRepresentative(node->m_resolverUplink);
+
+		size_t transitionCount = node->m_transitionArray.getCount();
+		sl::Array<LaDfaTransition>::Rwi rwi = node->m_transitionArray;
+		for (size_t j = 0; j < transitionCount; j++)
+			rwi[j].m_node = (LaDfaNode*)getRepresentative(rwi[j].m_node);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		LaDfaNode* node = m_nodeArray[i];
+		if (m_representativeArray[m_classArray[i]] != node)
+			list->erase(node);
+		else
+			node->m_masterIndex = -1;
+	}
+
+	m_nodeArray.clear();
+	m_classArray.clear();
+	m_representativeArray.clear();
+}
+
+void
+LaDfaMinimizer::appendSignature(
+	sl::String* string,
+	LaDfaNode* node
+) {
+	// leaves are never emitted, transitions to them go straight to the production
+
+	if (node->m_flags & LaDfaNodeFlag_Leaf) {
+		string->appendFormat("leaf %p", node->m_production);
+		return;
+	}
+
+	string->appendFormat(
+		"%d %p %p",
+		node->m_resolverUplink != NULL, // chained resolvers are emitted separately
+		node->m_resolver,
+		node->m_production
+	);
+
+	if (node->m_resolverElse)
+		string->appendFormat(" else %d", getClass(node->m_resolverElse));
+
+	size_t transitionCount = node->m_transitionArray.getCount();
+	for (size_t i = 0; i < transitionCount; i++) {
+		const LaDfaTransition& transition = node->m_transitionArray[i];
+		string->appendFormat(" %p:%d", transition.m_token, getClass(transition.m_node));
+	}
+}
+
+//..............................................................................
@@ -0,0 +1,52 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "Node.h"
+#include "PartitionRefiner.h"
+
+//..............................................................................
+
+// merges equivalent lookahead DFA nodes (Moore partition refinement): nodes are
+// equivalent if they emit the same code and their transitions lead to
+// equivalent nodes on the same tokens
+//
+// usage: calcEquivalence(), redirect all outside references with
+// getRepresentative(), then removeDuplicates()
+
+class LaDfaMinimizer: public PartitionRefiner<LaDfaNode> {
+public:
+	size_t
+	calcEquivalence(sl::List<LaDfaNode>* list); // returns the number of duplicates
+
+	Node*
+	getRepresentative(Node* node);
+
+	void
+	removeDuplicates(sl::List<LaDfaNode>* list);
+
+protected:
+	virtual
+	void
+	appendSignature(
+		sl::String* string,
+		LaDfaNode* node
+	);
+
+	size_t
+	getClass(Node* node) {
+		ASSERT(node->m_nodeKind == NodeKind_LaDfa && node->m_masterIndex < m_nodeArray.getCount());
+		return m_classArray[node->m_masterIndex];
+	}
+};
+
+//..............................................................................
@@ -0,0 +1,115 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "LuaLazyTable.h"
+
+//..............................................................................
+
+void
+LuaLazyTable::luaExport(
+	lua::LuaState* luaState,
+	const sl::StringRef& name
+) {
+	lua_State* h = luaState->getH();
+
+	lua_createtable(h, 0, 0);
+	lua_createtable(h, 0, 4); // metatable
+
+	lua_pushlightuserdata(h, this);
+	lua_pushcclosure(h, luaIndex, 1);
+	lua_setfield(h, -2, "__index");
+
+	lua_pushlightuserdata(h, this);
+	lua_pushcclosure(h, luaLen, 1);
+	lua_setfield(h, -2, "__len");
+
+	// elements are 1..count, so pairs() and ipairs() are the same
+
+	lua_pushlightuserdata(h, this);
+	lua_pushcclosure(h, luaPairs, 1);
+	lua_setfield(h, -2, "__pairs");
+
+	lua_pushlightuserdata(h, this);
+	lua_pushcclosure(h, luaPairs, 1);
+	lua_setfield(h, -2, "__ipairs");
+
+	lua_setmetatable(h, -2);
+	luaState->setGlobal(name);
+}
+
+void
+LuaLazyTable::luaGetGlobalElement(
+	lua::LuaState* luaState,
+	const char* name,
+	size_t index
+) {
+	lua_State* h = luaState->getH();
+	lua_getglobal(h, name);
+	lua_pushinteger(h, index);
+	lua_gettable(h, -2);
+	lua_remove(h, -2);
+}
+
+int
+LuaLazyTable::luaIndex(lua_State* h) {
+	LuaLazyTable* self = (LuaLazyTable*)lua_touserdata(h, lua_upvalueindex(1));
+
+	int isInteger = 0;
+	lua_Integer index = lua_tointegerx(h, 2, &isInteger);
+	if (!isInteger || index < 1 || (size_t)index > self->getCount()) {
+		lua_pushnil(h);
+		return 1;
+	}
+
+	lua::LuaState luaState;
+	luaState.attach(h);
+	self->luaExportElement(&luaState, (size_t)index - 1);
+	luaState.detach();
+
+	lua_pushvalue(h, -1);
+	lua_rawseti(h, 1, index); // next time it's found without __index
+	return 1;
+}
+
+int
+LuaLazyTable::luaLen(lua_State* h) {
+	LuaLazyTable* self = (LuaLazyTable*)lua_touserdata(h, lua_upvalueindex(1));
+	lua_pushinteger(h, self->getCount());
+	return 1;
+}
+
+int
+LuaLazyTable::luaPairs(lua_State* h) {
+	lua_pushvalue(h, lua_upvalueindex(1));
+	lua_pushcclosure(h, luaNext, 1);
+	lua_pushvalue(h, 1);
+	lua_pushinteger(h, 0);
+	return 3; // iterator, table, initial index
+}
+
+int
+LuaLazyTable::luaNext(lua_State* h) {
+	LuaLazyTable* self = (LuaLazyTable*)lua_touserdata(h, lua_upvalueindex(1));
+
+	lua_Integer index = lua_tointeger(h, 2) + 1;
+	if ((size_t)index > self->getCount()) {
+		lua_pushnil(h);
+		return 1;
+	}
+
+	lua_pushinteger(h, index);
+	lua_pushinteger(h, index);
+	lua_gettable(h, 1); // through __index
+	return 2;
+}
+
+//..............................................................................
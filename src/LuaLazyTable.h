@@ -0,0 +1,72 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// a Lua table which is empty at first: __index exports the requested element
+// from the C++ side on first access (and caches it in the table, so the element
+// identity is stable), __len reports the full element count, __pairs/__ipairs
+// iterate over all elements through __index. Frames only pay for what they
+// read. The object must outlive the Lua state it's exported into
+
+class LuaLazyTable {
+public:
+	virtual
+	~LuaLazyTable() {}
+
+	virtual
+	size_t
+	getCount() = 0;
+
+	virtual
+	void
+	luaExportElement(
+		lua::LuaState* luaState,
+		size_t index
+	) = 0; // must push exactly one value
+
+	void
+	luaExport(
+		lua::LuaState* luaState,
+		const sl::StringRef& name
+	);
+
+	// pushes name[index] going through metamethods (unlike raw access)
+
+	static
+	void
+	luaGetGlobalElement(
+		lua::LuaState* luaState,
+		const char* name,
+		size_t index
+	);
+
+protected:
+	static
+	int
+	luaIndex(lua_State* h);
+
+	static
+	int
+	luaLen(lua_State* h);
+
+	static
+	int
+	luaPairs(lua_State* h);
+
+	static
+	int
+	luaNext(lua_State* h);
+};
+
+//..............................................................................
@@ -14,19 +14,68 @@
 #include "ProductionBuilder.h"
 #include "ParseTableBuilder.h"
 #include "LaDfaBuilder.h"
+#include "LaDfaMinimizer.h"
+#include "NodeSharer.h"
+#include "SymbolInliner.h"
+#include "WorkerPool.h"
+
+//..............................................................................
+
+// conflicts are independent of each other, so they are resolved by a pool of
+// workers, each with its own builder; results are merged in the conflict order
+
+struct ConflictJob {
+	const CmdLine* m_cmdLine;
+	NodeMgr* m_nodeMgr;
+	const ParseTable* m_parseTable;
+	const sl::Array<size_t>* m_tokenClassArray;
+	size_t m_tokenClassCount;
+	const sl::Array<ConflictNode*>* m_conflictArray;
+	const sl::Array<LaDfaResult*>* m_resultArray;
+	std::atomic<size_t> m_nextIndex;
+};
+
+static
+void
+runConflictJob(ConflictJob* job) {
+	LaDfaBuilder builder(
+		job->m_cmdLine,
+		job->m_nodeMgr,
+		job->m_parseTable,
+		job->m_tokenClassArray,
+		job->m_tokenClassCount
+	);
+
+	size_t count = job->m_conflictArray->getCount();
+
+	for (;;) {
+		size_t i = job->m_nextIndex++;
+		if (i >= count)
+			break;
+
+		LaDfaResult* result = (*job->m_resultArray)[i];
+		builder.build((*job->m_conflictArray)[i], result);
+		if (!result->m_resultNode)
+			result->m_error = err::getLastError();
+	}
+}
 
 //..............................................................................
 
 Module::Module() {
 	m_maxUsedLookahead = 1;
+	m_luaParseTable.m_parseTable = &m_parseTable;
 }
 
 void
 Module::clear() {
 	m_sourceCache.clear();
 	m_parseTable.clear();
+	m_tokenClassArray.clear();
+	m_tokenClassRepresentativeArray.clear();
 	m_defineMgr.clear();
 	m_nodeMgr.clear();
+	m_shardMap.clear();
 	m_importList.clear();
 	m_maxUsedLookahead = 1;
 }
@@ -83,58 +132,222 @@ Module::build(const CmdLine* cmdLine) {
 			return false;
 	}
 
+	// merge identical quantifiers, groups & sequences (needs resolved beacons)
+
+	if (!(cmdLine->m_flags & CmdLineFlag_NoNodeSharing)) {
+		NodeSharer nodeSharer(&m_nodeMgr);
+		size_t sharedCount = nodeSharer.share();
+		if (sharedCount)
+			m_nodeMgr.reindexGrammarNodes();
+	}
+
+	// save prediction steps on pass-through symbols (no nodes are deleted, so no re-indexing)
+
+	if (!(cmdLine->m_flags & CmdLineFlag_NoInlining)) {
+		SymbolInliner symbolInliner(&m_nodeMgr);
+		size_t inlineCount = symbolInliner.inlineSymbols();
+		if (inlineCount && (cmdLine->m_flags & CmdLineFlag_Verbose))
+			printf("inlined %d pass-through symbol references\n", inlineCount);
+	}
+
 	m_nodeMgr.indexBeacons(); // index only after unneeded beacons have been removed
 	m_nodeMgr.indexDispatchers();
 
 	// build parse table
 
-	ParseTableBuilder parseTableBuilder(&m_nodeMgr, &m_parseTable);
+	ParseTableBuilder parseTableBuilder(cmdLine, &m_nodeMgr, &m_parseTable);
 	result = parseTableBuilder.build();
 	if (!result)
 		return false;
 
 	// resolve conflicts
 
-	LaDfaBuilder builder(cmdLine, &m_nodeMgr, &m_parseTable);
-	sl::Iterator<ConflictNode> conflictIt = m_nodeMgr.m_conflictList.getHead();
-	for (; conflictIt; conflictIt++) {
-		ConflictNode* conflict = *conflictIt;
-
-		conflict->m_resultNode = builder.build(conflict);
-		if (!conflict->m_resultNode)
-			return false;
-	}
+	result = resolveConflicts(cmdLine);
+	if (!result)
+		return false;
 
 	// replace conflicts with dfas or with direct productions (could happen in conflicts with epsilon productions or with anytoken)
 
-	sl::Array<Node*>::Rwi rwi = m_parseTable;
-	size_t tokenCount = m_nodeMgr.m_tokenArray.getCount();
-	conflictIt = m_nodeMgr.m_conflictList.getHead();
+	sl::Iterator<ConflictNode> conflictIt = m_nodeMgr.m_conflictList.getHead();
 	for (; conflictIt; conflictIt++) {
 		ConflictNode* conflict = *conflictIt;
-		Node** production = &rwi[conflict->m_symbol->m_index * tokenCount + conflict->m_token->m_index];
+		Node** production = m_parseTable.visit(conflict->m_symbol->m_index, conflict->m_token->m_index);
 		ASSERT(*production == conflict);
 		*production = conflict->m_resultNode;
 	}
 
 	symbolIt = m_nodeMgr.m_resolverSymbolList.getHead();
 	for (; symbolIt; symbolIt++)
-		if (!(symbolIt->m_flags & SymbolNodeFlag_ResolverUsed)) {
+		if (!(symbolIt->m_flags & (SymbolNodeFlag_ResolverUsed | SymbolNodeFlag_ResolverScanned))) {
 			err::setError("unused resolver");
 			lex::pushSrcPosError(symbolIt->m_srcPos);
 			return false;
 		}
 
+	shareLaDfaNodes();
+
+	m_nodeMgr.calcStackDepths();
 	m_nodeMgr.indexLaDfaNodes();
-	m_maxUsedLookahead = builder.getMaxUsedLookahead();
+	calcTokenClasses(&m_tokenClassArray, &m_tokenClassRepresentativeArray);
+	m_nodeMgr.prepareLuaExport();
+	m_shardMap.build(&m_nodeMgr, 1);
+	return true;
+}
+
+bool
+Module::resolveConflicts(const CmdLine* cmdLine) {
+	m_maxUsedLookahead = 1;
+
+	size_t count = m_nodeMgr.m_conflictList.getCount();
+	if (!count)
+		return true;
+
+	sl::List<LaDfaResult> resultList;
+	sl::Array<ConflictNode*> conflictArray;
+	sl::Array<LaDfaResult*> resultArray;
+	conflictArray.setCount(count);
+	resultArray.setCount(count);
+	sl::Array<ConflictNode*>::Rwi conflictRwi = conflictArray;
+	sl::Array<LaDfaResult*>::Rwi resultRwi = resultArray;
+
+	sl::Iterator<ConflictNode> conflictIt = m_nodeMgr.m_conflictList.getHead();
+	for (size_t i = 0; conflictIt; conflictIt++, i++) {
+		conflictRwi[i] = *conflictIt;
+		resultRwi[i] = new LaDfaResult;
+		resultList.insertTail(resultRwi[i]);
+	}
+
+	// conflict cells are unique per token, so these classes never merge tokens
+	// which the lookahead DFA builder would have to tell apart through a conflict
+
+	sl::Array<size_t> tokenClassArray;
+	sl::Array<size_t> tokenClassRepresentativeArray;
+	calcTokenClasses(&tokenClassArray, &tokenClassRepresentativeArray);
+
+	ConflictJob job;
+	job.m_cmdLine = cmdLine;
+	job.m_nodeMgr = &m_nodeMgr;
+	job.m_parseTable = &m_parseTable;
+	job.m_tokenClassArray = &tokenClassArray;
+	job.m_tokenClassCount = tokenClassRepresentativeArray.getCount();
+	job.m_conflictArray = &conflictArray;
+	job.m_resultArray = &resultArray;
+	job.m_nextIndex = 0;
+
+	// verbose traces must come out in the conflict order, so resolve those on this thread
+
+	size_t threadCount = (cmdLine->m_flags & CmdLineFlag_Verbose) ?
+		1 :
+		getWorkerThreadCount(cmdLine->m_jobCount, count);
+
+	runWorkerPool(threadCount, runConflictJob, &job);
+
+	// merge in the conflict order -- same nodes, names and errors as a sequential run
+
+	for (size_t i = 0; i < count; i++) {
+		ConflictNode* conflict = conflictArray[i];
+		LaDfaResult* result = resultArray[i];
+
+		if (!result->m_resultNode) {
+			err::setError(result->m_error);
+			return false;
+		}
+
+		conflict->m_resultNode = result->m_resultNode;
+		conflict->m_lookahead = result->m_lookahead;
+		m_nodeMgr.addLaDfaNodes(&result->m_laDfaList, &result->m_arena);
+
+		size_t resolverCount = result->m_usedResolverArray.getCount();
+		for (size_t j = 0; j < resolverCount; j++)
+			result->m_usedResolverArray[j]->m_flags |= SymbolNodeFlag_ResolverUsed;
+
+		resolverCount = result->m_scannedResolverArray.getCount();
+		for (size_t j = 0; j < resolverCount; j++)
+			result->m_scannedResolverArray[j]->m_flags |= SymbolNodeFlag_ResolverScanned;
+
+		if (result->m_lookahead > m_maxUsedLookahead)
+			m_maxUsedLookahead = result->m_lookahead;
+	}
+
 	return true;
 }
 
+// different conflicts over the same productions often yield identical DFAs;
+// minimizing all the DFAs at once emits each of those only once
+
+void
+Module::shareLaDfaNodes() {
+	if (m_nodeMgr.m_laDfaList.isEmpty())
+		return;
+
+	LaDfaMinimizer minimizer;
+	size_t duplicateCount = minimizer.calcEquivalence(&m_nodeMgr.m_laDfaList);
+	if (duplicateCount) {
+		size_t symbolCount = m_parseTable.getSymbolCount();
+		for (size_t i = 0; i < symbolCount; i++) {
+			sl::Array<ParseTableEntry>& row = m_parseTable.getRow(i);
+			size_t count = row.getCount();
+			sl::Array<ParseTableEntry>::Rwi rwi = row;
+			for (size_t j = 0; j < count; j++)
+				rwi[j].m_production = minimizer.getRepresentative(rwi[j].m_production);
+		}
+
+		sl::Iterator<ConflictNode> conflictIt = m_nodeMgr.m_conflictList.getHead();
+		for (; conflictIt; conflictIt++)
+			conflictIt->m_resultNode = minimizer.getRepresentative(conflictIt->m_resultNode);
+	}
+
+	minimizer.removeDuplicates(&m_nodeMgr.m_laDfaList);
+}
+
+// tokens with identical parse table columns are indistinguishable for symbol
+// prediction, so the generated table only needs a column per class; computed
+// again on the final table, where shared DFAs make more columns identical
+
+void
+Module::calcTokenClasses(
+	sl::Array<size_t>* classArray,
+	sl::Array<size_t>* representativeArray
+) {
+	size_t symbolCount = m_nodeMgr.m_symbolArray.getCount();
+	size_t tokenCount = m_nodeMgr.m_tokenArray.getCount();
+
+	classArray->setCount(tokenCount);
+	representativeArray->clear();
+	sl::Array<size_t>::Rwi rwi = *classArray;
+
+	// collect sparse columns from the rows: "symbol:production" for filled entries
+
+	sl::Array<sl::String> columnArray;
+	columnArray.setCount(tokenCount);
+	sl::Array<sl::String>::Rwi columnRwi = columnArray;
+
+	for (size_t i = 0; i < symbolCount; i++) {
+		const sl::Array<ParseTableEntry>& row = m_parseTable.getRow(i);
+		size_t count = row.getCount();
+		for (size_t j = 0; j < count; j++)
+			columnRwi[row[j].m_tokenIndex].appendFormat("%d:%p ", i, row[j].m_production);
+	}
+
+	sl::StringHashTable<size_t> columnMap;
+
+	for (size_t i = 0; i < tokenCount; i++) {
+		sl::StringHashTableIterator<size_t> it = columnMap.visit(columnArray[i]);
+		if (!it->m_value) { // 0 means new, so classes are stored 1-based
+			representativeArray->append(i);
+			it->m_value = representativeArray->getCount();
+		}
+
+		rwi[i] = it->m_value - 1;
+	}
+}
+
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
 void
 Module::trace() {
 	printf("LOOKAHEAD: %d\n", m_maxUsedLookahead);
+	printf("TOKEN CLASSES: %d/%d\n", m_tokenClassRepresentativeArray.getCount(), m_tokenClassArray.getCount());
 	m_nodeMgr.trace();
 }
 
@@ -158,6 +371,72 @@ Module::writeBnfFile(
 	return true;
 }
 
+bool
+Module::writeLookaheadReport(const sl::StringRef& fileName) {
+	io::File file;
+	bool result =
+		file.open(fileName) &&
+		file.setSize(0);
+
+	if (!result)
+		return false;
+
+	sl::String string = generateLookaheadReport();
+	file.write(string, string.getLength());
+	return true;
+}
+
+// the lookahead each conflict actually needed (the DFA is built breadth-first,
+// so that's the minimal k), then rules annotated with more than their
+// conflicts need
+
+sl::String
+Module::generateLookaheadReport() {
+	sl::String string;
+
+	sl::Array<size_t> lookaheadArray; // symbol index -> max lookahead of its conflicts
+	lookaheadArray.setCountZeroConstruct(m_nodeMgr.m_symbolArray.getCount());
+	sl::Array<size_t>::Rwi rwi = lookaheadArray;
+
+	string.appendFormat("conflicts: %d\n", m_nodeMgr.m_conflictList.getCount());
+
+	sl::Iterator<ConflictNode> conflictIt = m_nodeMgr.m_conflictList.getHead();
+	for (; conflictIt; conflictIt++) {
+		ConflictNode* conflict = *conflictIt;
+		string.appendFormat(
+			"\t%s:%s\t%d\n",
+			conflict->m_symbol->m_name.sz(),
+			conflict->m_token->m_name.sz(),
+			conflict->m_lookahead
+		);
+
+		size_t index = conflict->m_symbol->m_index;
+		if (conflict->m_lookahead > rwi[index])
+			rwi[index] = conflict->m_lookahead;
+	}
+
+	string.appendFormat("max lookahead: %d\n", m_maxUsedLookahead);
+	string.append("over-provisioned:\n");
+
+	size_t count = m_nodeMgr.m_symbolArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		SymbolNode* symbol = m_nodeMgr.m_symbolArray[i];
+		if (!(symbol->m_flags & SymbolNodeFlag_LookaheadSpecified))
+			continue;
+
+		size_t lookahead = rwi[i] ? rwi[i] : 1;
+		if (symbol->m_lookaheadLimit > lookahead)
+			string.appendFormat(
+				"\t%s\tlookahead(%d), needs %d\n",
+				symbol->m_name.sz(),
+				symbol->m_lookaheadLimit,
+				lookahead
+			);
+	}
+
+	return string;
+}
+
 sl::String
 Module::generateBnfString(BnfDialect dialect) {
 	sl::String string;
@@ -210,28 +489,30 @@ void
 Module::luaExport(lua::LuaState* luaState) {
 	m_defineMgr.luaExport(luaState);
 	m_nodeMgr.luaExport(luaState);
+	m_shardMap.luaExport(luaState);
 	luaExportParseTable(luaState);
 }
 
 void
 Module::luaExportParseTable(lua::LuaState* luaState) {
-	size_t symbolCount = m_nodeMgr.m_symbolArray.getCount();
 	size_t tokenCount = m_nodeMgr.m_tokenArray.getCount();
 
-	luaState->createTable(symbolCount);
+	m_luaParseTable.luaExport(luaState, "ParseTable");
 
-	for (size_t i = 0, k = 0; i < symbolCount; i++) {
-		luaState->createTable(tokenCount);
+	size_t classCount = m_tokenClassRepresentativeArray.getCount();
+	luaState->createTable(tokenCount);
 
-		for (size_t j = 0; j < tokenCount; j++, k++) {
-			Node* production = m_parseTable[k];
-			luaState->setArrayElementInteger(j + 1, production ? production->m_masterIndex : -1);
-		}
+	for (size_t i = 0; i < tokenCount; i++)
+		luaState->setArrayElementInteger(i + 1, m_tokenClassArray[i]);
 
-		luaState->setArrayElement(i + 1);
-	}
+	luaState->setGlobal("TokenClassTable");
+
+	luaState->createTable(classCount);
+
+	for (size_t i = 0; i < classCount; i++)
+		luaState->setArrayElementInteger(i + 1, m_tokenClassRepresentativeArray[i]);
 
-	luaState->setGlobal("ParseTable");
+	luaState->setGlobal("TokenClassRepresentativeTable");
 }
 
 //..............................................................................
@@ -12,7 +12,9 @@
 #pragma once
 
 #include "NodeMgr.h"
+#include "ParseTable.h"
 #include "DefineMgr.h"
+#include "ShardMap.h"
 #include "CmdLine.h"
 
 //..............................................................................
@@ -26,13 +28,19 @@ enum BnfDialect {
 
 class Module {
 	friend class Parser;
+	friend class SentenceGenerator;
+	friend class CppGenerator;
 
 protected:
 	sl::BoxList<sl::String> m_sourceCache;
-	sl::Array<Node*> m_parseTable;
+	ParseTable m_parseTable;
+	LuaLazyParseTable m_luaParseTable;
+	sl::Array<size_t> m_tokenClassArray;                // token index -> class
+	sl::Array<size_t> m_tokenClassRepresentativeArray; // class -> token index
 	size_t m_maxUsedLookahead;
 	DefineMgr m_defineMgr;
 	NodeMgr m_nodeMgr;
+	ShardMap m_shardMap;
 
 public:
 	sl::BoxList<sl::String> m_importList;
@@ -56,6 +64,13 @@ public:
 	bool
 	build(const CmdLine* cmdLine);
 
+	// must be done before generating (build leaves a single shard)
+
+	void
+	buildShardMap(size_t shardCount) {
+		m_shardMap.build(&m_nodeMgr, shardCount);
+	}
+
 	void
 	luaExport(lua::LuaState* luaState);
 
@@ -71,7 +86,25 @@ public:
 		BnfDialect dialect = BnfDialect_Classic
 	);
 
+	sl::String
+	generateLookaheadReport();
+
+	bool
+	writeLookaheadReport(const sl::StringRef& fileName);
+
 protected:
+	bool
+	resolveConflicts(const CmdLine* cmdLine);
+
+	void
+	shareLaDfaNodes();
+
+	void
+	calcTokenClasses(
+		sl::Array<size_t>* classArray,
+		sl::Array<size_t>* representativeArray
+	);
+
 	void
 	luaExportParseTable(lua::LuaState* luaState);
 };
@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "Node.h"
+#include "LuaLazyTable.h"
 
 //..............................................................................
 
@@ -37,9 +38,30 @@ Node::markReachable() {
 
 //..............................................................................
 
+void
+StackDepth::merge(
+	const StackDepth& depth,
+	size_t predictionBase
+) {
+	if (!depth.isCalculated()) // recursion
+		return;
+
+	size_t predictionDepth = predictionBase + depth.m_predictionDepth;
+	if (m_predictionDepth == -1 || m_predictionDepth < predictionDepth)
+		m_predictionDepth = predictionDepth;
+
+	m_symbolDepth = AXL_MAX(m_symbolDepth, depth.m_symbolDepth);
+	m_catchDepth = AXL_MAX(m_catchDepth, depth.m_catchDepth);
+	m_resolverDepth = AXL_MAX(m_resolverDepth, depth.m_resolverDepth);
+}
+
+//..............................................................................
+
 GrammarNode::GrammarNode() {
 	m_quantifierKind = 0;
 	m_quantifiedNode = NULL;
+	m_sccIndex = -1;
+	m_sccLowLink = -1;
 }
 
 void
@@ -286,6 +308,15 @@ SymbolNode::trace() {
 	if (m_resolver)
 		printf("\t  RSLVR:  %s\n", m_resolver->m_name.sz());
 
+	if (m_stackDepth.isCalculated())
+		printf(
+			"\t  STACK:  %d/%d/%d/%d (p/s/c/r)\n",
+			m_stackDepth.m_predictionDepth,
+			m_stackDepth.m_symbolDepth,
+			m_stackDepth.m_catchDepth,
+			m_stackDepth.m_resolverDepth
+		);
+
 	size_t childrenCount = m_productionArray.getCount();
 
 	for (size_t i = 0; i < childrenCount; i++) {
@@ -360,13 +391,20 @@ SymbolNode::luaExport(lua::LuaState* luaState) {
 
 	luaState->setMember("paramNameTable");
 
+	if (m_stackDepth.isCalculated()) {
+		luaState->setMemberInteger("predictionStackDepth", m_stackDepth.m_predictionDepth);
+		luaState->setMemberInteger("symbolStackDepth", m_stackDepth.m_symbolDepth);
+		luaState->setMemberInteger("catchStackDepth", m_stackDepth.m_catchDepth);
+		luaState->setMemberInteger("resolverStackDepth", m_stackDepth.m_resolverDepth);
+	}
+
 	if (m_synchronizer) {
 		size_t count = m_synchronizer->m_firstArray.getCount();
 		luaState->createTable(count);
 
 		for (size_t i = 0; i < count; i++) {
 			SymbolNode* token = m_synchronizer->m_firstArray[i];
-			luaState->getGlobalArrayElement("TokenTable", token->m_index + 1);
+			LuaLazyTable::luaGetGlobalElement(luaState, "TokenTable", token->m_index + 1);
 			luaState->setArrayElement(i + 1);
 		}
 
@@ -584,11 +622,11 @@ ActionNode::luaExport(lua::LuaState* luaState) {
 	luaState->createTable(0, 2);
 
 	if (m_dispatcher) {
-		luaState->getGlobalArrayElement("DispatcherTable", m_dispatcher->m_index + 1);
+		LuaLazyTable::luaGetGlobalElement(luaState, "DispatcherTable", m_dispatcher->m_index + 1);
 		luaState->setMember("dispatcher");
 	}
 
-	luaState->getGlobalArrayElement("SymbolTable", m_productionSymbol->m_index + 1);
+	LuaLazyTable::luaGetGlobalElement(luaState, "SymbolTable", m_productionSymbol->m_index + 1);
 	luaState->setMember("productionSymbol");
 
 	luaState->setMemberString("userCode", m_userCode);
@@ -635,13 +673,13 @@ ArgumentNode::luaExport(lua::LuaState* luaState) {
 	luaState->createTable(0, 3);
 
 	if (m_dispatcher) {
-		luaState->getGlobalArrayElement("DispatcherTable", m_dispatcher->m_index + 1);
+		LuaLazyTable::luaGetGlobalElement(luaState, "DispatcherTable", m_dispatcher->m_index + 1);
 		luaState->setMember("dispatcher");
 	}
 
-	luaState->getGlobalArrayElement("SymbolTable", m_productionSymbol->m_index + 1);
+	LuaLazyTable::luaGetGlobalElement(luaState, "SymbolTable", m_productionSymbol->m_index + 1);
 	luaState->setMember("productionSymbol");
-	luaState->getGlobalArrayElement("SymbolTable", m_targetSymbol->m_index + 1);
+	LuaLazyTable::luaGetGlobalElement(luaState, "SymbolTable", m_targetSymbol->m_index + 1);
 	luaState->setMember("targetSymbol");
 
 	luaState->createTable(m_argValueList.getCount());
@@ -736,7 +774,7 @@ void
 DispatcherNode::luaExport(lua::LuaState* luaState) {
 	luaState->createTable(0, 3);
 
-	luaState->getGlobalArrayElement("SymbolTable", m_symbol->m_index + 1);
+	LuaLazyTable::luaGetGlobalElement(luaState, "SymbolTable", m_symbol->m_index + 1);
 	luaState->setMember("symbol");
 
 	size_t beaconCount = m_beaconArray.getCount();
@@ -748,7 +786,7 @@ DispatcherNode::luaExport(lua::LuaState* luaState) {
 
 		luaState->createTable(1);
 		if (beacon->m_target->m_nodeKind == NodeKind_Symbol) {
-			luaState->getGlobalArrayElement("SymbolTable", beacon->m_target->m_index + 1);
+			LuaLazyTable::luaGetGlobalElement(luaState, "SymbolTable", beacon->m_target->m_index + 1);
 			luaState->setMember("symbol");
 		}
 
@@ -765,6 +803,7 @@ ConflictNode::ConflictNode() {
 	m_symbol = NULL;
 	m_token = NULL;
 	m_resultNode = NULL;
+	m_lookahead = 0;
 }
 
 void
@@ -776,11 +815,13 @@ ConflictNode::trace() {
 		"%s\n"
 		"\t  on %s in %s\n"
 		"\t  DFA:      %s\n"
+		"\t  LOOKAHEAD: %d\n"
 		"\t  POSSIBLE:\n",
 		m_name.sz(),
 		m_token->m_name.sz(),
 		m_symbol->m_name.sz(),
-		m_resultNode ? m_resultNode->m_name.sz() : "<none>"
+		m_resultNode ? m_resultNode->m_name.sz() : "<none>",
+		m_lookahead
 	);
 
 	size_t count = m_productionArray.getCount();
@@ -794,7 +835,6 @@ ConflictNode::trace() {
 
 LaDfaNode::LaDfaNode() {
 	m_nodeKind = NodeKind_LaDfa;
-	m_token = NULL;
 	m_resolver = NULL;
 	m_resolverElse = NULL;
 	m_resolverUplink = NULL;
@@ -821,11 +861,11 @@ LaDfaNode::trace() {
 	} else {
 		size_t count = m_transitionArray.getCount();
 		for (size_t i = 0; i < count; i++) {
-			LaDfaNode* child = m_transitionArray[i];
+			const LaDfaTransition& transition = m_transitionArray[i];
 			printf(
 				"\t  %s -> %s\n",
-				child->m_token->m_name.sz(),
-				child->getProductionString().sz()
+				transition.m_token->m_name.sz(),
+				transition.m_node->getProductionString().sz()
 			);
 		}
 
@@ -879,13 +919,14 @@ LaDfaNode::luaExport(lua::LuaState* luaState) {
 	Node* defaultProduction = m_production;
 
 	for (size_t i = 0; i < childrenCount; i++) {
-		LaDfaNode* child = m_transitionArray[i];
+		SymbolNode* token = m_transitionArray[i].m_token;
+		LaDfaNode* child = m_transitionArray[i].m_node;
 
-		if ((child->m_token->m_flags & SymbolNodeFlag_AnyToken) && !defaultProduction)
+		if ((token->m_flags & SymbolNodeFlag_AnyToken) && !defaultProduction)
 			defaultProduction = child->m_production;
 
 		luaState->createTable(0, 4);
-		luaState->getGlobalArrayElement("TokenTable", child->m_token->m_index + 1);
+		LuaLazyTable::luaGetGlobalElement(luaState, "TokenTable", token->m_index + 1);
 		luaState->setMember("token");
 
 		if (child->m_resolver)
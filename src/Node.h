@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include "Arena.h"
+
 //..............................................................................
 
 // forwards
@@ -46,7 +48,9 @@ enum NodeFlag {
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
-class Node: public sl::ListLink {
+class Node:
+	public sl::ListLink,
+	public ArenaObject {
 public:
 	NodeKind m_nodeKind;
 	uint_t m_flags;
@@ -88,10 +92,40 @@ public:
 
 //..............................................................................
 
+// run-time stack depths required to parse a grammar node (recursion is unrolled once)
+
+struct StackDepth {
+	size_t m_predictionDepth;
+	size_t m_symbolDepth;
+	size_t m_catchDepth;
+	size_t m_resolverDepth;
+
+	StackDepth() {
+		m_predictionDepth = -1;
+		m_symbolDepth = 0;
+		m_catchDepth = 0;
+		m_resolverDepth = 0;
+	}
+
+	bool
+	isCalculated() const {
+		return m_predictionDepth != -1;
+	}
+
+	void
+	merge(
+		const StackDepth& depth,
+		size_t predictionBase = 0
+	);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 enum GrammarNodeFlag {
 	GrammarNodeFlag_Nullable        = 0x0010,
 	GrammarNodeFlag_Final           = 0x0020,
 	GrammarNodeFlag_WeaklyReachable = 0x0040, // remove from the grammar, but don't delete
+	GrammarNodeFlag_Queued          = 0x0080, // on the grammar props worklist
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -108,6 +142,12 @@ public:
 	sl::BitMap m_firstSet;
 	sl::BitMap m_followSet;
 
+	sl::Array<GrammarNode*> m_parentArray; // nodes reading FIRST & nullability of this one
+
+	StackDepth m_stackDepth;
+	size_t m_sccIndex;   // visit order while calculating stack depths
+	size_t m_sccLowLink; // lowest visit order reachable within the component
+
 public:
 	GrammarNode();
 
@@ -177,6 +217,8 @@ enum SymbolNodeFlag {
 	SymbolNodeFlag_Start        = 0x2000,
 	SymbolNodeFlag_Nullable     = 0x4000,
 	SymbolNodeFlag_ResolverUsed = 0x8000,
+	SymbolNodeFlag_LookaheadSpecified = 0x10000,
+	SymbolNodeFlag_ResolverScanned    = 0x20000,
 };
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
@@ -426,6 +468,7 @@ public:
 	SymbolNode* m_symbol;
 	SymbolNode* m_token;
 	Node* m_resultNode; // lookahead DFA or immediate production
+	size_t m_lookahead; // tokens actually needed to resolve
 	sl::Array<GrammarNode*> m_productionArray;
 
 public:
@@ -460,15 +503,24 @@ enum LaDfaNodeFlag {
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+// tokens live on transitions rather than on target nodes, so a node can be
+// reached on different tokens (i.e. shared)
+
+struct LaDfaTransition {
+	SymbolNode* m_token;
+	LaDfaNode* m_node;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 class LaDfaNode: public Node {
 public:
-	SymbolNode* m_token;
 	GrammarNode* m_resolver;
 	Node* m_resolverElse;
 	LaDfaNode* m_resolverUplink;
 	Node* m_production;
 
-	sl::Array<LaDfaNode*> m_transitionArray;
+	sl::Array<LaDfaTransition> m_transitionArray;
 
 public:
 	LaDfaNode();
@@ -486,6 +538,11 @@ protected:
 	luaExportResolverMembers(lua::LuaState* luaState);
 };
 
+// master index of the transition target (leaves are collapsed into productions)
+
+size_t
+getTransitionIndex(Node* node);
+
 //..............................................................................
 
 template <typename T>
@@ -40,6 +40,9 @@ NodeMgr::NodeMgr() {
 
 	m_pragmaStartSymbol.m_flags |= SymbolNodeFlag_Pragma;
 	m_pragmaStartSymbol.m_name = "pragma";
+
+	m_luaEnterTable.m_isSymbolRef = true;
+	m_luaLeaveTable.m_isSymbolRef = true;
 	m_primaryStartSymbol = NULL;
 
 	m_lookaheadLimit = 1;
@@ -78,6 +81,7 @@ NodeMgr::clear() {
 	m_conflictList.clear();
 	m_laDfaList.clear();
 	m_weaklyReachableNodeList.clear();
+	m_arena.reset();
 
 	m_tokenArray.clear();
 	m_symbolArray.clear();
@@ -109,7 +113,7 @@ NodeMgr::getTokenNode(int token) {
 	if (mapIt->m_value)
 		return mapIt->m_value;
 
-	SymbolNode* node = new SymbolNode;
+	SymbolNode* node = new (&m_arena) SymbolNode;
 	node->m_nodeKind = NodeKind_Token;
 	node->m_charToken = token;
 
@@ -130,7 +134,7 @@ NodeMgr::getSymbolNode(const sl::StringRef& name) {
 	if (mapIt->m_value)
 		return mapIt->m_value;
 
-	SymbolNode* node = new SymbolNode;
+	SymbolNode* node = new (&m_arena) SymbolNode;
 	node->m_flags = SymbolNodeFlag_User;
 	node->m_name = name;
 
@@ -142,7 +146,7 @@ NodeMgr::getSymbolNode(const sl::StringRef& name) {
 
 SymbolNode*
 NodeMgr::createCatchSymbolNode() {
-	SymbolNode* node = new SymbolNode;
+	SymbolNode* node = new (&m_arena) SymbolNode;
 	node->m_name.format("_cat%d", m_catchSymbolList.getCount() + 1);
 	node->m_lookaheadLimit = m_lookaheadLimit;
 	m_catchSymbolList.insertTail(node);
@@ -151,7 +155,7 @@ NodeMgr::createCatchSymbolNode() {
 
 SymbolNode*
 NodeMgr::createResolverSymbolNode() {
-	SymbolNode* node = new SymbolNode;
+	SymbolNode* node = new (&m_arena) SymbolNode;
 	node->m_name.format("_rslv%d", m_resolverSymbolList.getCount() + 1);
 	node->m_lookaheadLimit = m_lookaheadLimit;
 	m_resolverSymbolList.insertTail(node);
@@ -160,7 +164,7 @@ NodeMgr::createResolverSymbolNode() {
 
 SymbolNode*
 NodeMgr::createTempSymbolNode() {
-	SymbolNode* node = new SymbolNode;
+	SymbolNode* node = new (&m_arena) SymbolNode;
 	node->m_name.format("_tmp%d", m_tempSymbolList.getCount() + 1);
 	node->m_lookaheadLimit = m_lookaheadLimit;
 	m_tempSymbolList.insertTail(node);
@@ -169,7 +173,7 @@ NodeMgr::createTempSymbolNode() {
 
 SequenceNode*
 NodeMgr::createSequenceNode() {
-	SequenceNode* node = new SequenceNode;
+	SequenceNode* node = new (&m_arena) SequenceNode;
 	node->m_name.format("_seq%d", m_sequenceList.getCount() + 1);
 	m_sequenceList.insertTail(node);
 	return node;
@@ -184,7 +188,7 @@ NodeMgr::createSequenceNode(GrammarNode* node) {
 
 BeaconNode*
 NodeMgr::createBeaconNode(SymbolNode* target) {
-	BeaconNode* beaconNode = new BeaconNode;
+	BeaconNode* beaconNode = new (&m_arena) BeaconNode;
 	beaconNode->m_target = target;
 
 	if (target->m_nodeKind == NodeKind_Symbol)
@@ -213,7 +217,7 @@ NodeMgr::deleteBeaconNode(BeaconNode* node) {
 
 DispatcherNode*
 NodeMgr::createDispatcherNode(SymbolNode* symbol) {
-	DispatcherNode* dispatcherNode = new DispatcherNode;
+	DispatcherNode* dispatcherNode = new (&m_arena) DispatcherNode;
 	dispatcherNode->m_name.format("_dsp%d", m_dispatcherList.getCount() + 1);
 	dispatcherNode->m_symbol = symbol;
 	m_dispatcherList.insertTail(dispatcherNode);
@@ -222,7 +226,7 @@ NodeMgr::createDispatcherNode(SymbolNode* symbol) {
 
 ActionNode*
 NodeMgr::createActionNode() {
-	ActionNode* node = new ActionNode;
+	ActionNode* node = new (&m_arena) ActionNode;
 	node->m_name.format("_act%d", m_actionList.getCount() + 1);
 	m_actionList.insertTail(node);
 	return node;
@@ -230,7 +234,7 @@ NodeMgr::createActionNode() {
 
 ArgumentNode*
 NodeMgr::createArgumentNode() {
-	ArgumentNode* node = new ArgumentNode;
+	ArgumentNode* node = new (&m_arena) ArgumentNode;
 	node->m_name.format("_arg%d", m_argumentList.getCount() + 1);
 	m_argumentList.insertTail(node);
 	return node;
@@ -238,18 +242,30 @@ NodeMgr::createArgumentNode() {
 
 ConflictNode*
 NodeMgr::createConflictNode() {
-	ConflictNode* node = new ConflictNode;
+	ConflictNode* node = new (&m_arena) ConflictNode;
 	node->m_name.format("_cnf%d", m_conflictList.getCount() + 1);
 	m_conflictList.insertTail(node);
 	return node;
 }
 
-LaDfaNode*
-NodeMgr::createLaDfaNode() {
-	LaDfaNode* node = new LaDfaNode;
-	node->m_name.format("_dfa%d", m_laDfaList.getCount() + 1);
-	m_laDfaList.insertTail(node);
-	return node;
+void
+NodeMgr::addLaDfaNodes(
+	sl::List<LaDfaNode>* list,
+	Arena* arena
+) {
+	size_t baseCount = m_laDfaList.getCount();
+	m_arena.takeOver(arena);
+
+	while (!list->isEmpty()) {
+		LaDfaNode* node = list->removeHead();
+
+		// m_index holds the creation ordinal within the builder's list; name it
+		// exactly as if the node had been created here
+
+		node->m_name.format("_dfa%d", baseCount + node->m_index + 1);
+		node->m_index = -1;
+		m_laDfaList.insertTail(node);
+	}
 }
 
 GrammarNode*
@@ -529,6 +545,19 @@ NodeMgr::indexArguments() {
 	m_masterCount = j;
 }
 
+void
+NodeMgr::reindexGrammarNodes() {
+	m_symbolArray.clear();
+	m_enterArray.clear();
+	m_leaveArray.clear();
+	m_masterCount = m_tokenArray.getCount();
+
+	indexSymbols();
+	indexSequences();
+	indexActions();
+	indexArguments();
+}
+
 void
 NodeMgr::indexLaDfaNodes() {
 	size_t i = 0;
@@ -550,101 +579,269 @@ NodeMgr::indexLaDfaNodes() {
 
 // . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
 
+// stack depths are calculated per strongly connected component of the grammar
+// graph (Tarjan), callees first. Recursion is unrolled once: inside a recursive
+// component, each member first gets its depth without the recursive references,
+// then every member is recalculated once with those depths. Unlike stopping at
+// the first revisited node, this doesn't depend on where the traversal entered
+
 void
-NodeMgr::luaExport(lua::LuaState* luaState) {
-	luaState->setGlobalInteger("StartSymbol", m_primaryStartSymbol ? m_primaryStartSymbol->m_index : -1);
-	luaState->setGlobalInteger("PragmaStartSymbol", m_pragmaStartSymbol.m_index);
-	luaState->setGlobalInteger("NamedTokenCount", m_namedTokenList.getCount());
-	luaState->setGlobalInteger("NamedSymbolCount", m_namedSymbolList.getCount());
-	luaState->setGlobalInteger("CatchSymbolCount", m_catchSymbolList.getCount());
+NodeMgr::calcStackDepths() {
+	size_t sccIndex = 0;
+	sl::Array<GrammarNode*> sccStack;
 
-	luaExportNodeArray(luaState, "TokenTable", (Node* const*)m_tokenArray.cp(), m_tokenArray.getCount());
-	luaExportNodeArray(luaState, "SymbolTable", (Node* const*)m_symbolArray.cp(), m_symbolArray.getCount());
-	luaExportNodeList(luaState, "SequenceTable", m_sequenceList.getHead(), m_sequenceList.getCount());
-	luaExportNodeList(luaState, "BeaconTable", m_beaconList.getHead(), m_beaconList.getCount());
-	luaExportNodeList(luaState, "DispatcherTable", m_dispatcherList.getHead(), m_dispatcherList.getCount());
-	luaExportNodeList(luaState, "ActionTable", m_actionList.getHead(), m_actionList.getCount());
-	luaExportNodeList(luaState, "ArgumentTable", m_argumentList.getHead(), m_argumentList.getCount());
-	luaExportSymbolNodeRefArray(luaState, "EnterTable", m_enterArray, m_enterArray.getCount());
-	luaExportSymbolNodeRefArray(luaState, "LeaveTable", m_leaveArray, m_leaveArray.getCount());
+	sl::Iterator<SymbolNode> nodeIt = m_namedSymbolList.getHead();
+	for (; nodeIt; nodeIt++)
+		if (nodeIt->m_sccIndex == -1)
+			calcSccStackDepths(*nodeIt, &sccIndex, &sccStack);
 
-	luaExportLaDfaTable(luaState);
-}
+	if (m_pragmaStartSymbol.m_productionArray.isEmpty())
+		return;
 
-void
-NodeMgr::luaExportNodeList(
-	lua::LuaState* luaState,
-	const sl::StringRef& name,
-	sl::Iterator<Node> nodeIt,
-	size_t countEstimate
-) {
-	luaState->createTable(countEstimate);
+	// pragmas are pushed out of band, i.e. on top of any symbol
 
-	size_t i = 1;
+	if (m_pragmaStartSymbol.m_sccIndex == -1)
+		calcSccStackDepths(&m_pragmaStartSymbol, &sccIndex, &sccStack);
 
-	for (; nodeIt; nodeIt++, i++) {
-		nodeIt->luaExport(luaState);
-		luaState->setArrayElement(i);
-	}
+	const StackDepth& pragmaDepth = m_pragmaStartSymbol.m_stackDepth;
 
-	luaState->setGlobal(name);
+	nodeIt = m_namedSymbolList.getHead();
+	for (; nodeIt; nodeIt++) {
+		StackDepth& depth = nodeIt->m_stackDepth;
+		depth.m_predictionDepth += pragmaDepth.m_predictionDepth;
+		depth.m_symbolDepth += pragmaDepth.m_symbolDepth;
+		depth.m_catchDepth += pragmaDepth.m_catchDepth;
+		depth.m_resolverDepth += pragmaDepth.m_resolverDepth;
+	}
 }
 
 void
-NodeMgr::luaExportNodeArray(
-	lua::LuaState* luaState,
-	const sl::StringRef& name,
-	Node* const* nodeArray,
-	size_t count
+NodeMgr::calcSccStackDepths(
+	GrammarNode* node,
+	size_t* sccIndex,
+	sl::Array<GrammarNode*>* sccStack
 ) {
-	luaState->createTable(count);
+	node->m_sccIndex = *sccIndex;
+	node->m_sccLowLink = *sccIndex;
+	(*sccIndex)++;
 
+	sccStack->append(node);
+	node->m_flags |= NodeFlag_RecursionStopper; // on the component stack
+
+	sl::Array<GrammarNode*> childArray;
+	getStackDepthChildren(&childArray, node);
+
+	size_t count = childArray.getCount();
 	for (size_t i = 0; i < count; i++) {
-		Node* node = nodeArray[i];
-		node->luaExport(luaState);
-		luaState->setArrayElement(i + 1);
+		GrammarNode* child = childArray[i];
+		if (child->m_sccIndex == -1) {
+			calcSccStackDepths(child, sccIndex, sccStack);
+			node->m_sccLowLink = AXL_MIN(node->m_sccLowLink, child->m_sccLowLink);
+		} else if (child->m_flags & NodeFlag_RecursionStopper) {
+			node->m_sccLowLink = AXL_MIN(node->m_sccLowLink, child->m_sccIndex);
+		}
 	}
 
+	if (node->m_sccLowLink != node->m_sccIndex) // not the root of a component
+		return;
+
+	size_t start = sccStack->getCount() - 1;
+	while ((*sccStack)[start] != node)
+		start--;
+
+	// everything outside of the component is calculated by now; references to
+	// members are skipped in the first round (StackDepth::merge ignores them)
+
+	size_t end = sccStack->getCount();
+	sl::Array<StackDepth> depthArray;
+	depthArray.setCount(end - start);
+	sl::Array<StackDepth>::Rwi depthRwi = depthArray;
 
-	luaState->setGlobal(name);
+	for (size_t i = start; i < end; i++)
+		depthRwi[i - start] = calcStackDepth((*sccStack)[i]);
+
+	for (size_t i = start; i < end; i++) {
+		GrammarNode* member = (*sccStack)[i];
+		member->m_flags &= ~NodeFlag_RecursionStopper;
+		member->m_stackDepth = depthRwi[i - start];
+	}
+
+	for (size_t i = start; i < end; i++)
+		depthRwi[i - start] = calcStackDepth((*sccStack)[i]);
+
+	for (size_t i = start; i < end; i++)
+		(*sccStack)[i]->m_stackDepth = depthRwi[i - start];
+
+	sccStack->setCount(start);
 }
 
 void
-NodeMgr::luaExportSymbolNodeRefArray(
-	lua::LuaState* luaState,
-	const sl::StringRef& name,
-	SymbolNode* const* nodeArray,
-	size_t count
+NodeMgr::getStackDepthChildren(
+	sl::Array<GrammarNode*>* childArray,
+	GrammarNode* node
 ) {
-	luaState->createTable(count);
+	SymbolNode* symbol;
+	SequenceNode* sequence;
 
-	for (size_t i = 0; i < count; i++) {
-		Node* node = nodeArray[i];
-		luaState->getGlobalArrayElement("SymbolTable", node->m_index + 1);
-		luaState->setArrayElement(i + 1);
+	switch (node->m_nodeKind) {
+	case NodeKind_Beacon:
+		childArray->append(((BeaconNode*)node)->m_target);
+		break;
+
+	case NodeKind_Sequence:
+		sequence = (SequenceNode*)node;
+		childArray->copy(sequence->m_sequence.cp(), sequence->m_sequence.getCount());
+		break;
+
+	case NodeKind_Symbol:
+		symbol = (SymbolNode*)node;
+		childArray->copy(symbol->m_productionArray.cp(), symbol->m_productionArray.getCount());
+		if (symbol->m_resolver)
+			childArray->append(symbol->m_resolver);
+		break;
+
+	default: // leaves
+		break;
 	}
+}
+
+// from the current depths of the children
+
+StackDepth
+NodeMgr::calcStackDepth(GrammarNode* node) {
+	StackDepth depth;
+	StackDepth resolverDepth;
+	SymbolNode* symbol;
+	SequenceNode* sequence;
+	BeaconNode* beacon;
+	size_t count;
+
+	switch (node->m_nodeKind) {
+	case NodeKind_Epsilon:
+		depth.m_predictionDepth = 0;
+		break;
+
+	case NodeKind_Token:
+	case NodeKind_Action:
+	case NodeKind_Argument:
+		depth.m_predictionDepth = 1;
+		break;
+
+	case NodeKind_Beacon:
+		beacon = (BeaconNode*)node;
+		depth.merge(beacon->m_target->m_stackDepth);
+		break;
+
+	case NodeKind_Sequence:
+		sequence = (SequenceNode*)node;
+		count = sequence->m_sequence.getCount();
+		depth.m_predictionDepth = count;
 
+		for (size_t i = 0; i < count; i++) {
+			GrammarNode* child = sequence->m_sequence[i];
+			depth.merge(child->m_stackDepth, count - i - 1); // the rest of the sequence is below the child
+		}
+
+		break;
 
-	luaState->setGlobal(name);
+	case NodeKind_Symbol:
+		symbol = (SymbolNode*)node;
+		depth.m_predictionDepth = 0;
+
+		count = symbol->m_productionArray.getCount();
+		for (size_t i = 0; i < count; i++) {
+			GrammarNode* production = symbol->m_productionArray[i];
+			depth.merge(production->m_stackDepth);
+		}
+
+		if (symbol->m_resolver) { // resolver is pushed on top of the lookahead DFA node
+			resolverDepth = symbol->m_resolver->m_stackDepth;
+			if (resolverDepth.isCalculated())
+				resolverDepth.m_resolverDepth++;
+
+			depth.merge(resolverDepth, 1);
+		}
+
+		if (symbol->m_flags & SymbolNodeFlag_User) { // named symbols stay on the stack until matched
+			depth.m_predictionDepth++;
+			depth.m_symbolDepth++;
+		} else if (symbol->m_synchronizer) { // so do catchers
+			depth.m_predictionDepth++;
+			depth.m_catchDepth++;
+		} else if (!depth.m_predictionDepth) { // temp symbols are replaced with the production
+			depth.m_predictionDepth = 1;
+		}
+
+		break;
+
+	default:
+		ASSERT(false);
+	}
+
+	return depth;
 }
 
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
 void
-NodeMgr::luaExportLaDfaTable(lua::LuaState* luaState) {
-	luaState->createTable(m_laDfaList.getCount());
+NodeMgr::prepareLuaExport() {
+	m_luaTokenTable.setNodeArray((Node* const*)m_tokenArray.cp(), m_tokenArray.getCount());
+	m_luaSymbolTable.setNodeArray((Node* const*)m_symbolArray.cp(), m_symbolArray.getCount());
+	m_luaSequenceTable.setNodeList(m_sequenceList.getHead());
+	m_luaBeaconTable.setNodeList(m_beaconList.getHead());
+	m_luaDispatcherTable.setNodeList(m_dispatcherList.getHead());
+	m_luaActionTable.setNodeList(m_actionList.getHead());
+	m_luaArgumentTable.setNodeList(m_argumentList.getHead());
+	m_luaEnterTable.setNodeArray((Node* const*)m_enterArray.cp(), m_enterArray.getCount());
+	m_luaLeaveTable.setNodeArray((Node* const*)m_leaveArray.cp(), m_leaveArray.getCount());
+
+	m_luaLaDfaTable.m_nodeArray.clear();
 
-	size_t i = 1;
 	sl::Iterator<LaDfaNode> nodeIt = m_laDfaList.getHead();
+	for (; nodeIt; nodeIt++)
+		if (nodeIt->m_masterIndex != -1)
+			m_luaLaDfaTable.m_nodeArray.append(*nodeIt);
+}
 
-	for (; nodeIt; nodeIt++) {
-		LaDfaNode* node = *nodeIt;
+void
+NodeMgr::luaExport(lua::LuaState* luaState) {
+	luaState->setGlobalInteger("StartSymbol", m_primaryStartSymbol ? m_primaryStartSymbol->m_index : -1);
+	luaState->setGlobalInteger("PragmaStartSymbol", m_pragmaStartSymbol.m_index);
+	luaState->setGlobalInteger("NamedTokenCount", m_namedTokenList.getCount());
+	luaState->setGlobalInteger("NamedSymbolCount", m_namedSymbolList.getCount());
+	luaState->setGlobalInteger("CatchSymbolCount", m_catchSymbolList.getCount());
 
-		if (node->m_masterIndex != -1) {
-			node->luaExport(luaState);
-			luaState->setArrayElement(i++);
-		}
-	}
+	m_luaTokenTable.luaExport(luaState, "TokenTable");
+	m_luaSymbolTable.luaExport(luaState, "SymbolTable");
+	m_luaSequenceTable.luaExport(luaState, "SequenceTable");
+	m_luaBeaconTable.luaExport(luaState, "BeaconTable");
+	m_luaDispatcherTable.luaExport(luaState, "DispatcherTable");
+	m_luaActionTable.luaExport(luaState, "ActionTable");
+	m_luaArgumentTable.luaExport(luaState, "ArgumentTable");
+	m_luaEnterTable.luaExport(luaState, "EnterTable");
+	m_luaLeaveTable.luaExport(luaState, "LeaveTable");
+	m_luaLaDfaTable.luaExport(luaState, "LaDfaTable");
+}
 
-	luaState->setGlobal("LaDfaTable");
+//..............................................................................
+
+void
+LuaLazyNodeTable::setNodeList(sl::Iterator<Node> nodeIt) {
+	m_nodeArray.clear();
+	for (; nodeIt; nodeIt++)
+		m_nodeArray.append(*nodeIt);
+}
+
+void
+LuaLazyNodeTable::luaExportElement(
+	lua::LuaState* luaState,
+	size_t index
+) {
+	Node* node = m_nodeArray[index];
+	if (m_isSymbolRef)
+		luaGetGlobalElement(luaState, "SymbolTable", node->m_index + 1);
+	else
+		node->luaExport(luaState);
 }
 
 //..............................................................................
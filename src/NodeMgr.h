@@ -12,6 +12,47 @@
 #pragma once
 
 #include "Node.h"
+#include "LuaLazyTable.h"
+
+//..............................................................................
+
+// exports nodes on demand; symbol references (EnterTable, LeaveTable) resolve
+// to the SymbolTable elements
+
+class LuaLazyNodeTable: public LuaLazyTable {
+public:
+	sl::Array<Node*> m_nodeArray;
+	bool m_isSymbolRef;
+
+public:
+	LuaLazyNodeTable() {
+		m_isSymbolRef = false;
+	}
+
+	void
+	setNodeArray(
+		Node* const* nodeArray,
+		size_t count
+	) {
+		m_nodeArray.copy(nodeArray, count);
+	}
+
+	void
+	setNodeList(sl::Iterator<Node> nodeIt);
+
+	virtual
+	size_t
+	getCount() {
+		return m_nodeArray.getCount();
+	}
+
+	virtual
+	void
+	luaExportElement(
+		lua::LuaState* luaState,
+		size_t index
+	);
+};
 
 //..............................................................................
 
@@ -20,8 +61,15 @@ class NodeMgr {
 	friend class Parser;
 	friend class LaDfaBuilder;
 	friend class ParseTableBuilder;
+	friend class SentenceGenerator;
+	friend class CppGenerator;
+	friend class NodeSharer;
+	friend class SymbolInliner;
+	friend class ShardMap;
 
 protected:
+	Arena m_arena; // must outlive the node lists below
+
 	sl::SimpleHashTable<int, SymbolNode*> m_tokenMap;
 	sl::StringHashTable<SymbolNode*> m_symbolMap;
 
@@ -54,6 +102,17 @@ protected:
 	size_t m_lookaheadLimit;
 	size_t m_masterCount;
 
+	LuaLazyNodeTable m_luaTokenTable;
+	LuaLazyNodeTable m_luaSymbolTable;
+	LuaLazyNodeTable m_luaSequenceTable;
+	LuaLazyNodeTable m_luaBeaconTable;
+	LuaLazyNodeTable m_luaDispatcherTable;
+	LuaLazyNodeTable m_luaActionTable;
+	LuaLazyNodeTable m_luaArgumentTable;
+	LuaLazyNodeTable m_luaEnterTable;
+	LuaLazyNodeTable m_luaLeaveTable;
+	LuaLazyNodeTable m_luaLaDfaTable;
+
 public:
 	NodeMgr();
 
@@ -65,6 +124,12 @@ public:
 	void
 	clear();
 
+	// fills the lazy tables; after that, luaExport only reads the node manager
+	// and may run concurrently for multiple Lua states
+
+	void
+	prepareLuaExport();
+
 	void
 	luaExport(lua::LuaState* luaState);
 
@@ -95,11 +160,6 @@ public:
 	void
 	deleteBeaconNode(BeaconNode* node);
 
-	void
-	deleteLaDfaNode(LaDfaNode* node) {
-		m_laDfaList.erase(node);
-	}
-
 	DispatcherNode*
 	createDispatcherNode(SymbolNode* symbol);
 
@@ -112,8 +172,11 @@ public:
 	ConflictNode*
 	createConflictNode();
 
-	LaDfaNode*
-	createLaDfaNode();
+	void
+	addLaDfaNodes(
+		sl::List<LaDfaNode>* list,
+		Arena* arena
+	);
 
 	GrammarNode*
 	createQuantifierNode(
@@ -152,39 +215,36 @@ public:
 	indexArguments();
 
 	void
-	indexLaDfaNodes();
+	reindexGrammarNodes(); // after nodes were merged or deleted
 
-protected:
-	template <typename T>
 	void
-	deleteUnreachableNodes(sl::List<T>* list);
+	indexLaDfaNodes();
 
 	void
-	luaExportLaDfaTable(lua::LuaState* luaState);
+	calcStackDepths();
 
+protected:
 	void
-	luaExportNodeArray(
-		lua::LuaState* luaState,
-		const sl::StringRef& name,
-		Node* const* node,
-		size_t count
+	calcSccStackDepths(
+		GrammarNode* node,
+		size_t* sccIndex,
+		sl::Array<GrammarNode*>* sccStack
 	);
 
+	static
 	void
-	luaExportSymbolNodeRefArray(
-		lua::LuaState* luaState,
-		const sl::StringRef& name,
-		SymbolNode* const* node,
-		size_t count
+	getStackDepthChildren(
+		sl::Array<GrammarNode*>* childArray,
+		GrammarNode* node
 	);
 
+	static
+	StackDepth
+	calcStackDepth(GrammarNode* node);
+
+	template <typename T>
 	void
-	luaExportNodeList(
-		lua::LuaState* luaState,
-		const sl::StringRef& name,
-		sl::Iterator<Node> node,
-		size_t countHint = 1
-	);
+	deleteUnreachableNodes(sl::List<T>* list);
 };
 
 
@@ -0,0 +1,197 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "NodeSharer.h"
+
+//..............................................................................
+
+NodeSharer::NodeSharer(NodeMgr* nodeMgr) {
+	m_nodeMgr = nodeMgr;
+}
+
+size_t
+NodeSharer::share() {
+	collectCandidates();
+
+	size_t count = m_nodeArray.getCount();
+	if (!count)
+		return 0;
+
+	refine(); // quantifier temp symbols are recursive, so plain bottom-up hashing is not enough
+
+	size_t duplicateCount = count - m_representativeArray.getCount();
+	if (!duplicateCount)
+		return 0;
+
+	// redirect all the references to representatives
+
+	replaceChildren(&m_nodeMgr->m_namedSymbolList);
+	replaceChildren(&m_nodeMgr->m_catchSymbolList);
+	replaceChildren(&m_nodeMgr->m_resolverSymbolList);
+	replaceChildren(&m_nodeMgr->m_tempSymbolList);
+	replaceChildren(&m_nodeMgr->m_pragmaStartSymbol);
+
+	sl::Iterator<SequenceNode> sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+	for (; sequenceIt; sequenceIt++)
+		replaceChildren(*sequenceIt);
+
+	sl::Iterator<GrammarNode> nodeIt = m_nodeMgr->m_weaklyReachableNodeList.getHead();
+	for (; nodeIt; nodeIt++)
+		replaceChildren(*nodeIt);
+
+	// and delete the duplicates
+
+	for (size_t i = 0; i < count; i++) {
+		GrammarNode* node = m_nodeArray[i];
+		if (m_representativeArray[m_classArray[i]] == node)
+			continue;
+
+		if (node->m_nodeKind == NodeKind_Symbol)
+			m_nodeMgr->m_tempSymbolList.erase((SymbolNode*)node);
+		else
+			m_nodeMgr->m_sequenceList.erase((SequenceNode*)node);
+	}
+
+	return duplicateCount;
+}
+
+bool
+NodeSharer::isCandidate(SymbolNode* symbol) {
+	return
+		!symbol->m_resolver &&
+		!symbol->m_synchronizer &&
+		!(symbol->m_flags & (SymbolNodeFlag_User | SymbolNodeFlag_Pragma | SymbolNodeFlag_Start)) &&
+		symbol->m_valueBlock.isEmpty() &&
+		symbol->m_paramBlock.isEmpty() &&
+		symbol->m_localBlock.isEmpty() &&
+		symbol->m_enterBlock.isEmpty() &&
+		symbol->m_leaveBlock.isEmpty();
+}
+
+void
+NodeSharer::collectCandidates() {
+	m_nodeArray.clear();
+	m_positionArray.setCount(m_nodeMgr->m_masterCount);
+	sl::Array<size_t>::Rwi rwi = m_positionArray;
+	for (size_t i = 0; i < m_nodeMgr->m_masterCount; i++)
+		rwi[i] = -1;
+
+	sl::Iterator<SymbolNode> symbolIt = m_nodeMgr->m_tempSymbolList.getHead();
+	for (; symbolIt; symbolIt++) {
+		SymbolNode* symbol = *symbolIt;
+		if (isCandidate(symbol)) {
+			rwi[symbol->m_masterIndex] = m_nodeArray.getCount();
+			m_nodeArray.append(symbol);
+		}
+	}
+
+	sl::Iterator<SequenceNode> sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+	for (; sequenceIt; sequenceIt++) {
+		SequenceNode* sequence = *sequenceIt;
+		rwi[sequence->m_masterIndex] = m_nodeArray.getCount();
+		m_nodeArray.append(sequence);
+	}
+}
+
+void
+NodeSharer::appendSignature(
+	sl::String* string,
+	GrammarNode* node
+) {
+	const sl::Array<GrammarNode*>* childArray;
+
+	if (node->m_nodeKind == NodeKind_Symbol) {
+		SymbolNode* symbol = (SymbolNode*)node;
+		string->appendFormat(
+			"sym %d %d",
+			symbol->m_quantifierKind,
+			symbol->m_lookaheadLimit
+		);
+
+		childArray = &symbol->m_productionArray;
+	} else {
+		ASSERT(node->m_nodeKind == NodeKind_Sequence);
+		string->appendFormat("seq %d", node->m_quantifierKind);
+		childArray = &((SequenceNode*)node)->m_sequence;
+	}
+
+	if (node->m_quantifiedNode)
+		appendChildSignature(string, node->m_quantifiedNode);
+
+	string->append(" :");
+
+	size_t count = childArray->getCount();
+	for (size_t i = 0; i < count; i++)
+		appendChildSignature(string, (*childArray)[i]);
+}
+
+void
+NodeSharer::appendChildSignature(
+	sl::String* string,
+	GrammarNode* node
+) {
+	size_t position = getPosition(node);
+	if (position != -1 && m_nodeArray[position] == node)
+		string->appendFormat(" c%d", m_classArray[position]);
+	else
+		string->appendFormat(" %p", node);
+}
+
+GrammarNode*
+NodeSharer::getRepresentative(GrammarNode* node) {
+	if (!node)
+		return NULL;
+
+	size_t position = getPosition(node);
+	return position != -1 && m_nodeArray[position] == node ?
+		m_representativeArray[m_classArray[position]] :
+		node;
+}
+
+void
+NodeSharer::replaceChildren(GrammarNode* node) {
+	node->m_quantifiedNode = getRepresentative(node->m_quantifiedNode);
+
+	SymbolNode* symbol;
+
+	switch (node->m_nodeKind) {
+	case NodeKind_Symbol:
+		symbol = (SymbolNode*)node;
+		symbol->m_synchronizer = getRepresentative(symbol->m_synchronizer);
+		replaceChildren(&symbol->m_productionArray);
+		break;
+
+	case NodeKind_Sequence:
+		replaceChildren(&((SequenceNode*)node)->m_sequence);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void
+NodeSharer::replaceChildren(sl::List<SymbolNode>* list) {
+	sl::Iterator<SymbolNode> symbolIt = list->getHead();
+	for (; symbolIt; symbolIt++)
+		replaceChildren(*symbolIt);
+}
+
+void
+NodeSharer::replaceChildren(sl::Array<GrammarNode*>* array) {
+	size_t count = array->getCount();
+	sl::Array<GrammarNode*>::Rwi rwi = *array;
+	for (size_t i = 0; i < count; i++)
+		rwi[i] = getRepresentative(rwi[i]);
+}
+
+//..............................................................................
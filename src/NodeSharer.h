@@ -0,0 +1,78 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "NodeMgr.h"
+#include "PartitionRefiner.h"
+
+//..............................................................................
+
+// hash-conses temp symbols (quantifiers, groups) and sequences: structurally
+// identical ones are merged into the first of them; children other than temp
+// symbols and sequences are compared by identity, so nodes with user code
+// (actions, arguments, used beacons) never merge. Runs after ProductionBuilder
+// (which replaces unused beacons with their targets), so nodes must be
+// re-indexed afterwards
+
+class NodeSharer: public PartitionRefiner<GrammarNode> {
+protected:
+	NodeMgr* m_nodeMgr;
+	sl::Array<size_t> m_positionArray; // master index -> candidate (-1 if none)
+
+public:
+	NodeSharer(NodeMgr* nodeMgr);
+
+	size_t
+	share(); // returns the number of deleted duplicates
+
+protected:
+	void
+	collectCandidates();
+
+	static
+	bool
+	isCandidate(SymbolNode* symbol);
+
+	virtual
+	void
+	appendSignature(
+		sl::String* string,
+		GrammarNode* node
+	);
+
+	void
+	appendChildSignature(
+		sl::String* string,
+		GrammarNode* node
+	);
+
+	size_t
+	getPosition(GrammarNode* node) {
+		return node->m_masterIndex < m_positionArray.getCount() ?
+			m_positionArray[node->m_masterIndex] :
+			-1;
+	}
+
+	GrammarNode*
+	getRepresentative(GrammarNode* node);
+
+	void
+	replaceChildren(GrammarNode* node);
+
+	void
+	replaceChildren(sl::Array<GrammarNode*>* array);
+
+	void
+	replaceChildren(sl::List<SymbolNode>* list);
+};
+
+//..............................................................................
@@ -0,0 +1,170 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "ParseTable.h"
+
+//..............................................................................
+
+static
+int
+cmpParseTableEntry(
+	const void* p1,
+	const void* p2
+) {
+	const ParseTableEntry* entry1 = (const ParseTableEntry*)p1;
+	const ParseTableEntry* entry2 = (const ParseTableEntry*)p2;
+
+	return
+		entry1->m_tokenIndex < entry2->m_tokenIndex ? -1 :
+		entry1->m_tokenIndex > entry2->m_tokenIndex ? 1 : 0;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+size_t
+ParseTable::getEntryCount() const {
+	size_t entryCount = 0;
+
+	size_t count = m_rowArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		entryCount += m_rowArray[i].getCount();
+
+	return entryCount;
+}
+
+void
+ParseTable::clear() {
+	m_rowArray.clear();
+	m_tokenCount = 0;
+}
+
+void
+ParseTable::create(
+	size_t symbolCount,
+	size_t tokenCount
+) {
+	m_rowArray.clear();
+	m_rowArray.setCount(symbolCount);
+	m_tokenCount = tokenCount;
+}
+
+void
+ParseTable::sortRows() {
+	size_t count = m_rowArray.getCount();
+	sl::Array<sl::Array<ParseTableEntry> >::Rwi rwi = m_rowArray;
+
+	for (size_t i = 0; i < count; i++) {
+		sl::Array<ParseTableEntry>::Rwi rowRwi = rwi[i];
+		qsort(rowRwi.p(), rwi[i].getCount(), sizeof(ParseTableEntry), cmpParseTableEntry);
+	}
+}
+
+Node*
+ParseTable::get(
+	size_t symbolIndex,
+	size_t tokenIndex
+) const {
+	ASSERT(symbolIndex < m_rowArray.getCount() && tokenIndex < m_tokenCount);
+
+	const sl::Array<ParseTableEntry>& row = m_rowArray[symbolIndex];
+	size_t i = findEntry(row, tokenIndex);
+	return i < row.getCount() && row[i].m_tokenIndex == tokenIndex ?
+		row[i].m_production :
+		NULL;
+}
+
+Node**
+ParseTable::visit(
+	size_t symbolIndex,
+	size_t tokenIndex
+) {
+	ASSERT(symbolIndex < m_rowArray.getCount() && tokenIndex < m_tokenCount);
+
+	sl::Array<ParseTableEntry>& row = getRow(symbolIndex);
+	size_t i = findEntry(row, tokenIndex);
+	if (i >= row.getCount() || row[i].m_tokenIndex != tokenIndex) {
+		ParseTableEntry entry = { tokenIndex, NULL };
+		row.insert(i, entry);
+	}
+
+	sl::Array<ParseTableEntry>::Rwi rwi = row;
+	return &rwi[i].m_production;
+}
+
+size_t
+ParseTable::findEntry(
+	const sl::Array<ParseTableEntry>& row,
+	size_t tokenIndex
+) {
+	size_t begin = 0;
+	size_t end = row.getCount();
+
+	while (begin < end) {
+		size_t mid = (begin + end) / 2;
+		if (row[mid].m_tokenIndex < tokenIndex)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+
+	return begin;
+}
+
+//..............................................................................
+
+void
+LuaLazyParseTable::luaExportElement(
+	lua::LuaState* luaState,
+	size_t index
+) {
+	const sl::Array<ParseTableEntry>& row = m_parseTable->getRow(index);
+	size_t count = row.getCount();
+	luaState->createTable(0, count);
+
+	for (size_t i = 0; i < count; i++)
+		luaState->setArrayElementInteger(row[i].m_tokenIndex + 1, row[i].m_production->m_masterIndex);
+
+	// all rows share one metatable per Lua state
+
+	lua_State* h = luaState->getH();
+	lua_getfield(h, LUA_REGISTRYINDEX, "graco.ParseTableRow");
+	if (lua_isnil(h, -1)) {
+		lua_pop(h, 1);
+		lua_createtable(h, 0, 2);
+
+		lua_pushcfunction(h, luaRowIndex);
+		lua_setfield(h, -2, "__index");
+
+		lua_pushinteger(h, m_parseTable->getTokenCount());
+		lua_pushcclosure(h, luaRowLen, 1);
+		lua_setfield(h, -2, "__len");
+
+		lua_pushvalue(h, -1);
+		lua_setfield(h, LUA_REGISTRYINDEX, "graco.ParseTableRow");
+	}
+
+	lua_setmetatable(h, -2);
+}
+
+int
+LuaLazyParseTable::luaRowIndex(lua_State* h) {
+	lua_pushinteger(h, -1); // only missing entries get here
+	return 1;
+}
+
+int
+LuaLazyParseTable::luaRowLen(lua_State* h) {
+	lua_pushvalue(h, lua_upvalueindex(1));
+	return 1;
+}
+
+//..............................................................................
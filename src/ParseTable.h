@@ -0,0 +1,136 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "Node.h"
+#include "LuaLazyTable.h"
+
+//..............................................................................
+
+struct ParseTableEntry {
+	size_t m_tokenIndex;
+	Node* m_production; // NULL only while being filled
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// rows only hold the filled entries, so the table takes memory proportional to
+// the number of entries rather than symbols * tokens. While the table is being
+// built, entries are appended to rows in any order; sortRows() sorts them by
+// token index once, and lookups (get, visit) only work after that
+
+class ParseTable {
+protected:
+	sl::Array<sl::Array<ParseTableEntry> > m_rowArray; // indexed by symbol index
+	size_t m_tokenCount;
+
+public:
+	ParseTable() {
+		m_tokenCount = 0;
+	}
+
+	size_t
+	getSymbolCount() const {
+		return m_rowArray.getCount();
+	}
+
+	size_t
+	getTokenCount() const {
+		return m_tokenCount;
+	}
+
+	size_t
+	getEntryCount() const;
+
+	const sl::Array<ParseTableEntry>&
+	getRow(size_t symbolIndex) const {
+		return m_rowArray[symbolIndex];
+	}
+
+	sl::Array<ParseTableEntry>&
+	getRow(size_t symbolIndex) {
+		sl::Array<sl::Array<ParseTableEntry> >::Rwi rwi = m_rowArray;
+		return rwi[symbolIndex];
+	}
+
+	void
+	clear();
+
+	void
+	create(
+		size_t symbolCount,
+		size_t tokenCount
+	);
+
+	void
+	sortRows();
+
+	Node*
+	get(
+		size_t symbolIndex,
+		size_t tokenIndex
+	) const; // NULL if no entry
+
+	Node**
+	visit(
+		size_t symbolIndex,
+		size_t tokenIndex
+	); // adds an empty entry if there is none
+
+protected:
+	static
+	size_t
+	findEntry(
+		const sl::Array<ParseTableEntry>& row,
+		size_t tokenIndex
+	); // returns the insertion position if not found
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// rows are exported on demand and only hold the filled entries (keyed by token
+// index + 1), so pairs() visits just those; the row metatable makes missing
+// entries read as -1 and # report the token count, as with full rows
+
+class LuaLazyParseTable: public LuaLazyTable {
+public:
+	const ParseTable* m_parseTable;
+
+public:
+	LuaLazyParseTable() {
+		m_parseTable = NULL;
+	}
+
+	virtual
+	size_t
+	getCount() {
+		return m_parseTable ? m_parseTable->getSymbolCount() : 0;
+	}
+
+	virtual
+	void
+	luaExportElement(
+		lua::LuaState* luaState,
+		size_t index
+	);
+
+protected:
+	static
+	int
+	luaRowIndex(lua_State* h);
+
+	static
+	int
+	luaRowLen(lua_State* h);
+};
+
+//..............................................................................
@@ -11,6 +11,7 @@
 
 #include "pch.h"
 #include "ParseTableBuilder.h"
+#include "BitMatrix.h"
 
 //..............................................................................
 
@@ -23,7 +24,14 @@ ParseTableBuilder::build() {
 	size_t symbolCount = m_nodeMgr->m_symbolArray.getCount();
 	size_t terminalCount = m_nodeMgr->m_tokenArray.getCount();
 
-	m_parseTable->setCountZeroConstruct(symbolCount * terminalCount);
+	m_parseTable->create(symbolCount, terminalCount);
+
+	m_entryIndexArray.setCount(terminalCount);
+	sl::Array<size_t>::Rwi rwi = m_entryIndexArray;
+	for (size_t i = 0; i < terminalCount; i++)
+		rwi[i] = -1;
+
+	m_rowIndex = -1;
 
 	// normal productions
 
@@ -108,6 +116,7 @@ ParseTableBuilder::build() {
 		}
 	}
 
+	m_parseTable->sortRows();
 	return true;
 }
 
@@ -152,22 +161,50 @@ ParseTableBuilder::addAnyTokenProductionToParseTable(
 	}
 }
 
+void
+ParseTableBuilder::selectRow(size_t symbolIndex) {
+	if (symbolIndex == m_rowIndex)
+		return;
+
+	sl::Array<size_t>::Rwi rwi = m_entryIndexArray;
+
+	if (m_rowIndex != -1) {
+		const sl::Array<ParseTableEntry>& row = m_parseTable->getRow(m_rowIndex);
+		size_t count = row.getCount();
+		for (size_t i = 0; i < count; i++)
+			rwi[row[i].m_tokenIndex] = -1;
+	}
+
+	const sl::Array<ParseTableEntry>& row = m_parseTable->getRow(symbolIndex);
+	size_t count = row.getCount();
+	for (size_t i = 0; i < count; i++)
+		rwi[row[i].m_tokenIndex] = i;
+
+	m_rowIndex = symbolIndex;
+}
+
 size_t
 ParseTableBuilder::addParseTableEntry(
 	SymbolNode* symbol,
 	SymbolNode* token,
 	GrammarNode* production
 ) {
-	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
-
-	Node** productionSlot = m_parseTable->p() + symbol->m_index * tokenCount + token->m_index;
-	Node* oldProduction = *productionSlot;
-
-	if (!oldProduction) {
-		*productionSlot = production;
+	selectRow(symbol->m_index);
+
+	sl::Array<ParseTableEntry>& row = m_parseTable->getRow(symbol->m_index);
+	size_t entryIdx = m_entryIndexArray[token->m_index];
+	if (entryIdx == -1) { // rows are sorted once the table is complete
+		ParseTableEntry entry = { token->m_index, production };
+		m_entryIndexArray.rwi()[token->m_index] = row.getCount();
+		row.append(entry);
 		return 0;
 	}
 
+	sl::Array<ParseTableEntry>::Rwi rowRwi = row;
+	Node** productionSlot = &rowRwi[entryIdx].m_production;
+	Node* oldProduction = *productionSlot;
+	ASSERT(oldProduction);
+
 	if (oldProduction == production)
 		return 0;
 
@@ -201,10 +238,280 @@ ParseTableBuilder::addParseTableEntry(
 	return conflict->m_productionArray.getCount();
 }
 
+static
+size_t
+getGrammarChildren(
+	GrammarNode* node,
+	GrammarNode* const** children
+) {
+	SymbolNode* symbol;
+	SequenceNode* sequence;
+
+	switch (node->m_nodeKind) {
+	case NodeKind_Symbol:
+		symbol = (SymbolNode*)node;
+		*children = symbol->m_productionArray.cp();
+		return symbol->m_productionArray.getCount();
+
+	case NodeKind_Sequence:
+		sequence = (SequenceNode*)node;
+		*children = sequence->m_sequence.cp();
+		return sequence->m_sequence.getCount();
+
+	case NodeKind_Beacon:
+		*children = (GrammarNode* const*)&((BeaconNode*)node)->m_target;
+		return 1;
+
+	default:
+		*children = NULL;
+		return 0;
+	}
+}
+
 void
-ParseTableBuilder::calcGrammarProps() {
+ParseTableBuilder::addGrammarPropsNode(
+	sl::Array<GrammarNode*>* queue,
+	GrammarNode* node
+) {
+	GrammarNode* const* children;
+	size_t childrenCount = getGrammarChildren(node, &children);
+	for (size_t i = 0; i < childrenCount; i++) {
+		GrammarNode* child = children[i];
+		if (child->m_nodeKind == NodeKind_Symbol ||
+			child->m_nodeKind == NodeKind_Sequence ||
+			child->m_nodeKind == NodeKind_Beacon) // FIRST & nullability of other nodes never change
+			child->m_parentArray.append(node);
+	}
+
+	enqueueGrammarPropsNode(queue, node);
+}
+
+void
+ParseTableBuilder::enqueueGrammarPropsNode(
+	sl::Array<GrammarNode*>* queue,
+	GrammarNode* node
+) {
+	if (node->m_flags & GrammarNodeFlag_Queued)
+		return;
+
+	node->m_flags |= GrammarNodeFlag_Queued;
+	queue->append(node);
+}
+
+static
+size_t
+findNodeId(
+	sl::SimpleHashTable<GrammarNode*, size_t>* nodeMap,
+	GrammarNode* node
+) {
+	sl::HashTableIterator<GrammarNode*, size_t> it = nodeMap->find(node);
+	return it ? it->m_value : -1;
+}
+
+static
+void
+setRowBits(
+	BitMatrix* matrix,
+	size_t row,
+	const sl::BitMap& bitMap,
+	size_t count
+) {
+	for (
+		size_t i = bitMap.findBit(0);
+		i < count; // -1 if none
+		i = bitMap.findBit(i + 1)
+	)
+		matrix->setBit(row, i);
+}
+
+static
+void
+setBitMapBits(
+	sl::BitMap* bitMap,
+	BitMatrix* matrix,
+	size_t row,
+	size_t count
+) {
+	for (size_t i = 0; i < count; i++)
+		if (matrix->getBit(row, i))
+			bitMap->setBitResize(i);
+}
+
+// default solver: a node is re-propagated only when its inputs change
+
+void
+ParseTableBuilder::calcGrammarPropsWorklist(const sl::Array<GrammarNode*>& nodeArray) {
+	sl::Array<GrammarNode*> queue;
+
+	size_t nodeCount = nodeArray.getCount();
+	for (size_t i = 0; i < nodeCount; i++)
+		addGrammarPropsNode(&queue, nodeArray[i]);
+
+	while (!queue.isEmpty()) {
+		GrammarNode* node = queue.getBack();
+		queue.pop();
+		node->m_flags &= ~GrammarNodeFlag_Queued;
+
+		if (!node->propagateGrammarProps())
+			continue;
+
+		// FIRST & nullability of the node are read by its parents,
+		// FOLLOW & finality of its children -- by the children themselves
+
+		GrammarNode* const* children;
+		size_t childrenCount = getGrammarChildren(node, &children);
+		for (size_t i = 0; i < childrenCount; i++)
+			enqueueGrammarPropsNode(&queue, children[i]);
+
+		size_t parentCount = node->m_parentArray.getCount();
+		for (size_t i = 0; i < parentCount; i++)
+			enqueueGrammarPropsNode(&queue, node->m_parentArray[i]);
+	}
+}
+
+// alternative solver for large grammars: nullability is a cheap boolean fixed
+// point, FIRST & FOLLOW are transitive closures of the "includes" relations
+// over bit matrices (finality rides along as an extra FOLLOW column). Leaf
+// children (tokens, actions, ...) are not in the matrices; they only get FOLLOW
+// & finality from their parents, so one final propagation pass covers them
+
+void
+ParseTableBuilder::calcGrammarPropsClosure(const sl::Array<GrammarNode*>& nodeArray) {
+	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
+	size_t nodeCount = nodeArray.getCount();
+
+	sl::SimpleHashTable<GrammarNode*, size_t> nodeMap;
+	for (size_t i = 0; i < nodeCount; i++)
+		nodeMap[nodeArray[i]] = i;
+
+	// nullability
+
 	bool hasChanged;
 
+	do {
+		hasChanged = false;
+
+		for (size_t i = 0; i < nodeCount; i++) {
+			GrammarNode* node = nodeArray[i];
+			if (node->isNullable())
+				continue;
+
+			GrammarNode* const* children;
+			size_t childrenCount = getGrammarChildren(node, &children);
+			bool isSequence = node->m_nodeKind == NodeKind_Sequence;
+			bool isNullable = isSequence; // sequence: all nullable; otherwise: any nullable
+
+			for (size_t j = 0; j < childrenCount; j++)
+				if (children[j]->isNullable() != isSequence) {
+					isNullable = !isSequence;
+					break;
+				}
+
+			if (isNullable) {
+				node->markNullable();
+				hasChanged = true;
+			}
+		}
+	} while (hasChanged);
+
+	// FIRST: columns are tokens followed by nodes
+
+	BitMatrix matrix;
+	matrix.create(nodeCount, tokenCount + nodeCount);
+
+	for (size_t i = 0; i < nodeCount; i++) {
+		GrammarNode* node = nodeArray[i];
+		setRowBits(&matrix, i, node->m_firstSet, tokenCount);
+
+		GrammarNode* const* children;
+		size_t childrenCount = getGrammarChildren(node, &children);
+		for (size_t j = 0; j < childrenCount; j++) {
+			GrammarNode* child = children[j];
+			size_t childId = findNodeId(&nodeMap, child);
+			if (childId != -1)
+				matrix.setBit(i, tokenCount + childId);
+			else
+				setRowBits(&matrix, i, child->m_firstSet, tokenCount);
+
+			if (node->m_nodeKind == NodeKind_Sequence && !child->isNullable())
+				break;
+		}
+	}
+
+	matrix.calcTransitiveClosure(tokenCount);
+
+	for (size_t i = 0; i < nodeCount; i++)
+		setBitMapBits(&nodeArray[i]->m_firstSet, &matrix, i, tokenCount);
+
+	// FOLLOW: columns are tokens, finality, then nodes; a row points to the nodes
+	// it inherits FOLLOW from
+
+	size_t finalColumn = tokenCount;
+	size_t firstNodeColumn = tokenCount + 1;
+
+	matrix.create(nodeCount, firstNodeColumn + nodeCount);
+
+	for (size_t i = 0; i < nodeCount; i++) {
+		GrammarNode* node = nodeArray[i];
+		setRowBits(&matrix, i, node->m_followSet, tokenCount);
+
+		if (node->isFinal())
+			matrix.setBit(i, finalColumn);
+	}
+
+	for (size_t i = 0; i < nodeCount; i++) {
+		GrammarNode* node = nodeArray[i];
+		GrammarNode* const* children;
+		size_t childrenCount = getGrammarChildren(node, &children);
+
+		if (node->m_nodeKind != NodeKind_Sequence) {
+			for (size_t j = 0; j < childrenCount; j++) {
+				size_t childId = findNodeId(&nodeMap, children[j]);
+				if (childId != -1)
+					matrix.setBit(childId, firstNodeColumn + i);
+			}
+
+			continue;
+		}
+
+		for (intptr_t j = childrenCount - 1; j >= 0; j--) {
+			size_t childId = findNodeId(&nodeMap, children[j]);
+			if (childId != -1)
+				matrix.setBit(childId, firstNodeColumn + i);
+
+			if (!children[j]->isNullable())
+				break;
+		}
+
+		for (size_t j = 0; j + 1 < childrenCount; j++) {
+			size_t childId = findNodeId(&nodeMap, children[j]);
+			if (childId == -1)
+				continue;
+
+			for (size_t k = j + 1; k < childrenCount; k++) {
+				setRowBits(&matrix, childId, children[k]->m_firstSet, tokenCount);
+				if (!children[k]->isNullable())
+					break;
+			}
+		}
+	}
+
+	matrix.calcTransitiveClosure(firstNodeColumn);
+
+	for (size_t i = 0; i < nodeCount; i++) {
+		GrammarNode* node = nodeArray[i];
+		setBitMapBits(&node->m_followSet, &matrix, i, tokenCount);
+
+		if (matrix.getBit(i, finalColumn))
+			node->markFinal();
+	}
+
+	for (size_t i = 0; i < nodeCount; i++)
+		nodeArray[i]->propagateGrammarProps();
+}
+
+void
+ParseTableBuilder::calcGrammarProps() {
 	GrammarNode* startSymbol = m_nodeMgr->m_symbolArray[0];
 	startSymbol->markFinal();
 
@@ -239,29 +546,25 @@ ParseTableBuilder::calcGrammarProps() {
 	for (; wrNodeIt; wrNodeIt++)
 		wrNodeIt->initializeFirstFollowSets(tokenCount);
 
-	do {
-		hasChanged = false;
-
-		for (size_t i = 0; i < symbolCount; i++)
-			if (m_nodeMgr->m_symbolArray[i]->propagateGrammarProps())
-				hasChanged = true;
+	sl::Array<GrammarNode*> nodeArray;
+	nodeArray.append((GrammarNode* const*)m_nodeMgr->m_symbolArray.cp(), symbolCount);
 
-		sequenceIt = m_nodeMgr->m_sequenceList.getHead();
-		for (; sequenceIt; sequenceIt++)
-			if (sequenceIt->propagateGrammarProps())
-				hasChanged = true;
+	sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+	for (; sequenceIt; sequenceIt++)
+		nodeArray.append(*sequenceIt);
 
-		beaconIt = m_nodeMgr->m_beaconList.getHead();
-		for (; beaconIt; beaconIt++)
-			if (beaconIt->propagateGrammarProps())
-				hasChanged = true;
+	beaconIt = m_nodeMgr->m_beaconList.getHead();
+	for (; beaconIt; beaconIt++)
+		nodeArray.append(*beaconIt);
 
-		wrNodeIt = m_nodeMgr->m_weaklyReachableNodeList.getHead();
-		for (; wrNodeIt; wrNodeIt++)
-			if (wrNodeIt->propagateGrammarProps())
-				hasChanged = true;
+	wrNodeIt = m_nodeMgr->m_weaklyReachableNodeList.getHead();
+	for (; wrNodeIt; wrNodeIt++)
+		nodeArray.append(*wrNodeIt);
 
-	} while (hasChanged);
+	if (m_cmdLine->m_flags & CmdLineFlag_ClosureGrammarProps)
+		calcGrammarPropsClosure(nodeArray);
+	else
+		calcGrammarPropsWorklist(nodeArray);
 
 	m_nodeMgr->m_anyTokenNode.buildFirstFollowArrays(m_nodeMgr->m_tokenArray);
 
@@ -12,21 +12,32 @@
 #pragma once
 
 #include "NodeMgr.h"
+#include "ParseTable.h"
+#include "CmdLine.h"
 
 //..............................................................................
 
 class ParseTableBuilder {
 protected:
+	const CmdLine* m_cmdLine;
 	NodeMgr* m_nodeMgr;
-	sl::Array<Node*>* m_parseTable;
+	ParseTable* m_parseTable;
+
+	// token index -> entry index in the row being filled (-1 if none)
+
+	sl::Array<size_t> m_entryIndexArray;
+	size_t m_rowIndex;
 
 public:
 	ParseTableBuilder(
+		const CmdLine* cmdLine,
 		NodeMgr* nodeMgr,
-		sl::Array<Node*>* parseTable
+		ParseTable* parseTable
 	) {
+		m_cmdLine = cmdLine;
 		m_nodeMgr = nodeMgr;
 		m_parseTable = parseTable;
+		m_rowIndex = -1;
 	}
 
 	bool
@@ -36,6 +47,25 @@ protected:
 	void
 	calcGrammarProps();
 
+	void
+	calcGrammarPropsWorklist(const sl::Array<GrammarNode*>& nodeArray);
+
+	void
+	calcGrammarPropsClosure(const sl::Array<GrammarNode*>& nodeArray);
+
+	void
+	addGrammarPropsNode(
+		sl::Array<GrammarNode*>* queue,
+		GrammarNode* node
+	);
+
+	static
+	void
+	enqueueGrammarPropsNode(
+		sl::Array<GrammarNode*>* queue,
+		GrammarNode* node
+	);
+
 	void
 	addProductionToParseTable(
 		SymbolNode* symbol,
@@ -48,6 +78,9 @@ protected:
 		GrammarNode* production
 	);
 
+	void
+	selectRow(size_t symbolIndex);
+
 	size_t
 	addParseTableEntry(
 		SymbolNode* symbol,
@@ -343,7 +343,7 @@ Parser::defineStatement() {
 	token = getToken();
 	switch (token->m_token) {
 	case '{':
-		return userCode('{', &define->m_stringValue, &define->m_srcPos);
+		return userCodeDefine(define);
 
 	case '=':
 		nextToken();
@@ -367,7 +367,7 @@ Parser::defineStatement() {
 			break;
 
 		case '{':
-			return userCode('{', &define->m_stringValue, &define->m_srcPos);
+			return userCodeDefine(define);
 
 		default:
 			err::setFormatStringError(
@@ -397,6 +397,18 @@ Parser::defineStatement() {
 	return true;
 }
 
+bool
+Parser::userCodeDefine(Define* define) {
+	bool result = userCode('{', &define->m_stringValue, &define->m_srcPos);
+	if (!result)
+		return false;
+
+	if (isUserCodeDiscarded())
+		define->m_stringValue.clear();
+
+	return true;
+}
+
 bool
 Parser::customizeSymbol(SymbolNode* node) {
 	bool result;
@@ -449,6 +461,14 @@ Parser::customizeSymbol(SymbolNode* node) {
 			return false;
 	}
 
+	if (isUserCodeDiscarded()) {
+		node->m_paramBlock.clear();
+		node->m_localBlock.clear();
+		node->m_enterBlock.clear();
+		node->m_leaveBlock.clear();
+		return true;
+	}
+
 	if (!node->m_paramBlock.isEmpty()) {
 		result = processParamBlock(node);
 		if (!result)
@@ -714,8 +734,11 @@ Parser::production(const ProductionSpecifiers* specifiers) {
 
 	nextToken();
 
-	symbol->m_valueBlock = specifiers->m_valueBlock;
-	symbol->m_valueLineCol = specifiers->m_valueLineCol;
+	if (!isUserCodeDiscarded()) {
+		symbol->m_valueBlock = specifiers->m_valueBlock;
+		symbol->m_valueLineCol = specifiers->m_valueLineCol;
+	}
+
 	symbol->m_flags |= specifiers->m_flags;
 	symbol->m_resolver = specifiers->m_resolver;
 
@@ -723,6 +746,9 @@ Parser::production(const ProductionSpecifiers* specifiers) {
 		specifiers->m_lookaheadLimit :
 		m_module->m_nodeMgr.m_lookaheadLimit;
 
+	if (specifiers->m_lookaheadLimit)
+		symbol->m_flags |= SymbolNodeFlag_LookaheadSpecified;
+
 	if (symbol->m_flags & SymbolNodeFlag_Pragma)
 		m_module->m_nodeMgr.m_pragmaStartSymbol.m_productionArray.append(symbol);
 
@@ -844,6 +870,16 @@ Parser::sequence() {
 		if (!node2)
 			return NULL;
 
+		if (isUserCodeDiscarded()) { // discarded actions leave epsilon nodes behind
+			if (node2->m_nodeKind == NodeKind_Epsilon)
+				continue;
+
+			if (node->m_nodeKind == NodeKind_Epsilon) {
+				node = node2;
+				continue;
+			}
+		}
+
 		if (!temp)
 			if (node->m_nodeKind == NodeKind_Sequence)
 				temp = (SequenceNode*)node;
@@ -916,7 +952,13 @@ Parser::primary() {
 			return NULL;
 
 		token = getToken();
-		if (token->m_token == '<') {
+		if (token->m_token == '<' && isUserCodeDiscarded()) {
+			sl::StringRef string;
+			lex::LineCol lineCol;
+			result = userCode('<', &string, &lineCol);
+			if (!result)
+				return NULL;
+		} else if (token->m_token == '<') {
 			BeaconNode* beacon = (BeaconNode*)node;
 			ArgumentNode* argument = m_module->m_nodeMgr.createArgumentNode();
 			SequenceNode* sequence = m_module->m_nodeMgr.createSequenceNode();
@@ -943,6 +985,17 @@ Parser::primary() {
 		break;
 
 	case '{':
+		if (isUserCodeDiscarded()) {
+			sl::StringRef string;
+			lex::LineCol lineCol;
+			result = userCode('{', &string, &lineCol);
+			if (!result)
+				return NULL;
+
+			node = &m_module->m_nodeMgr.m_epsilonNode;
+			break;
+		}
+
 		actionNode = m_module->m_nodeMgr.createActionNode();
 
 		result = userCode('{', &actionNode->m_userCode, &actionNode->m_srcPos);
@@ -54,6 +54,11 @@ public:
 	parseFile(const sl::StringRef& filePath);
 
 protected:
+	bool
+	isUserCodeDiscarded() {
+		return m_cmdLine && (m_cmdLine->m_flags & CmdLineFlag_NoUserCode);
+	}
+
 	// grammar
 
 	bool
@@ -121,6 +126,9 @@ protected:
 		lex::LineCol* lineCol
 	);
 
+	bool
+	userCodeDefine(Define* define);
+
 	bool
 	customizeSymbol(SymbolNode* node);
 
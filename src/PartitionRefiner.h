@@ -0,0 +1,88 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// Moore partition refinement over m_nodeArray: start with a single class and
+// split until stable. Derived classes build node signatures out of the current
+// classes of the nodes they lead to; the node's own class is prepended, so
+// classes never merge back. The first node of each class represents it
+
+template <typename T>
+class PartitionRefiner {
+protected:
+	sl::Array<T*> m_nodeArray;
+	sl::Array<size_t> m_classArray;      // indexed by node position
+	sl::Array<T*> m_representativeArray; // indexed by class
+
+public:
+	virtual
+	~PartitionRefiner() {}
+
+protected:
+	virtual
+	void
+	appendSignature(
+		sl::String* string,
+		T* node
+	) = 0;
+
+	void
+	refine();
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+template <typename T>
+void
+PartitionRefiner<T>::refine() {
+	size_t count = m_nodeArray.getCount();
+	m_classArray.clear();
+	m_classArray.setCountZeroConstruct(count);
+
+	size_t classCount = 1;
+
+	for (;;) {
+		sl::StringHashTable<size_t> signatureMap;
+		sl::Array<size_t> classArray;
+		classArray.setCount(count);
+		sl::Array<size_t>::Rwi classRwi = classArray;
+		m_representativeArray.clear();
+
+		sl::String signature;
+		for (size_t i = 0; i < count; i++) {
+			T* node = m_nodeArray[i];
+
+			signature.format("%d ", m_classArray[i]);
+			appendSignature(&signature, node);
+
+			sl::StringHashTableIterator<size_t> it = signatureMap.visit(signature);
+			if (!it->m_value) { // 0 means new, so classes are stored 1-based
+				m_representativeArray.append(node);
+				it->m_value = m_representativeArray.getCount();
+			}
+
+			classRwi[i] = it->m_value - 1;
+		}
+
+		m_classArray = classArray;
+
+		size_t newClassCount = m_representativeArray.getCount();
+		if (newClassCount == classCount)
+			break;
+
+		classCount = newClassCount;
+	}
+}
+
+//..............................................................................
@@ -0,0 +1,721 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "SentenceGenerator.h"
+#include "Module.h"
+
+//..............................................................................
+
+SentenceGenerator::SentenceGenerator(const CmdLine* cmdLine) {
+	m_cmdLine = cmdLine;
+	m_nodeMgr = NULL;
+	m_parseTable = NULL;
+	m_lookaheadIndex = 0;
+	m_lineLength = 0;
+	m_tokenCount = 0;
+	m_randomState = 1;
+}
+
+bool
+SentenceGenerator::generate(
+	Module* module,
+	const sl::StringRef& fileName
+) {
+	bool result;
+
+	m_nodeMgr = &module->m_nodeMgr;
+	m_parseTable = &module->m_parseTable;
+	m_buffer.clear();
+
+	m_randomState = (uint64_t)m_cmdLine->m_sentenceSeed * 0x9e3779b97f4a7c15ULL + 1;
+	if (!m_randomState)
+		m_randomState = 1;
+
+	// default spellings are the token names as accepted by token-stream loaders
+
+	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
+	m_spellingArray.setCount(tokenCount);
+	sl::Array<sl::String>::Rwi rwi = m_spellingArray;
+	for (size_t i = 0; i < tokenCount; i++)
+		rwi[i] = m_nodeMgr->m_tokenArray[i]->m_name;
+
+	if (!m_cmdLine->m_spellingFileName.isEmpty()) {
+		result = loadSpellingMap(m_cmdLine->m_spellingFileName);
+		if (!result)
+			return false;
+	}
+
+	calcHeights();
+
+	SymbolNode* start = m_nodeMgr->m_primaryStartSymbol;
+	if (m_symbolHeightArray[start->m_index] == -1) {
+		err::setFormatStringError("start symbol '%s' derives no finite sentence", start->m_name.sz());
+		return false;
+	}
+
+	result =
+		m_file.open(fileName) &&
+		m_file.setSize(0);
+
+	if (!result)
+		return false;
+
+	if (m_cmdLine->m_spellingFileName.isEmpty())
+		m_buffer.format(
+			"# random sentence(s) of '%s' (seed %d)\n",
+			start->m_name.sz(),
+			m_cmdLine->m_sentenceSeed
+		);
+
+	for (size_t i = 0; i < m_cmdLine->m_sentenceCount; i++) {
+		result =
+			(!i || emitString("%%\n")) && // sentence separator
+			generateSentence();
+
+		if (!result)
+			return false;
+	}
+
+	return flush();
+}
+
+bool
+SentenceGenerator::loadSpellingMap(const sl::StringRef& fileName) {
+	io::MappedFile file;
+
+	bool result = file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result)
+		return false;
+
+	size_t size = (size_t)file.getSize();
+	const char* p = (const char*)file.view(0, size);
+	if (!p)
+		return false;
+
+	sl::StringHashTable<size_t> tokenMap;
+	size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
+	sl::Array<sl::String>::Rwi rwi = m_spellingArray;
+	for (size_t i = 0; i < tokenCount; i++) {
+		SymbolNode* token = m_nodeMgr->m_tokenArray[i];
+		tokenMap[token->m_name] = i;
+
+		if (token->m_charToken) { // char tokens are spelled as-is unless overridden
+			char c = (char)token->m_charToken;
+			rwi[i] = sl::StringRef(&c, 1);
+		}
+	}
+
+	// each line is: <token-name> <spelling>
+
+	const char* end = p + size;
+	size_t line = 1;
+
+	for (; p < end; p++, line++) {
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+
+		if (p >= end || *p == '\n' || *p == '\r' || *p == '#') {
+			while (p < end && *p != '\n')
+				p++;
+
+			continue;
+		}
+
+		const char* name = p;
+		while (p < end && !isspace((uchar_t)*p))
+			p++;
+
+		sl::StringRef nameString(name, p - name);
+
+		while (p < end && (*p == ' ' || *p == '\t'))
+			p++;
+
+		const char* spelling = p;
+		while (p < end && *p != '\n')
+			p++;
+
+		const char* spellingEnd = p;
+		while (spellingEnd > spelling && isspace((uchar_t)spellingEnd[-1]))
+			spellingEnd--;
+
+		sl::StringHashTableIterator<size_t> it = tokenMap.find(nameString);
+		if (!it) {
+			err::setFormatStringError(
+				"%s(%d): unknown token '%s'",
+				fileName.sz(),
+				line,
+				nameString.sz()
+			);
+			return false;
+		}
+
+		rwi[it->m_value] = sl::StringRef(spelling, spellingEnd - spelling);
+	}
+
+	return true;
+}
+
+// minimal derivation heights -- choosing a production of minimal height strictly
+// reduces the height, so once we stop expanding, the sentence is guaranteed to end
+
+void
+SentenceGenerator::calcHeights() {
+	size_t symbolCount = m_nodeMgr->m_symbolArray.getCount();
+	size_t sequenceCount = m_nodeMgr->m_sequenceList.getCount();
+
+	m_symbolHeightArray.setCount(symbolCount);
+	m_sequenceHeightArray.setCount(sequenceCount);
+
+	sl::Array<size_t>::Rwi symbolRwi = m_symbolHeightArray;
+	sl::Array<size_t>::Rwi sequenceRwi = m_sequenceHeightArray;
+
+	for (size_t i = 0; i < symbolCount; i++)
+		symbolRwi[i] = -1;
+
+	for (size_t i = 0; i < sequenceCount; i++)
+		sequenceRwi[i] = -1;
+
+	bool isChanged;
+
+	do {
+		isChanged = false;
+
+		sl::Iterator<SequenceNode> sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+		for (; sequenceIt; sequenceIt++) {
+			SequenceNode* sequence = *sequenceIt;
+			size_t height = 0;
+			size_t count = sequence->m_sequence.getCount();
+			for (size_t i = 0; i < count; i++) {
+				size_t childHeight = getHeight(sequence->m_sequence[i]);
+				if (childHeight > height)
+					height = childHeight; // -1 is the largest
+			}
+
+			if (height < sequenceRwi[sequence->m_index]) {
+				sequenceRwi[sequence->m_index] = height;
+				isChanged = true;
+			}
+		}
+
+		for (size_t i = 0; i < symbolCount; i++) {
+			SymbolNode* symbol = m_nodeMgr->m_symbolArray[i];
+			size_t height = -1;
+			size_t count = symbol->m_productionArray.getCount();
+			for (size_t j = 0; j < count; j++) {
+				size_t productionHeight = getHeight(symbol->m_productionArray[j]);
+				if (productionHeight < height)
+					height = productionHeight;
+			}
+
+			if (height != -1 && height + 1 < symbolRwi[i]) {
+				symbolRwi[i] = height + 1;
+				isChanged = true;
+			}
+		}
+	} while (isChanged);
+}
+
+size_t
+SentenceGenerator::getHeight(Node* node) {
+	switch (node->m_nodeKind) {
+	case NodeKind_Epsilon:
+	case NodeKind_Token:
+	case NodeKind_Action:
+	case NodeKind_Argument:
+		return 0;
+
+	case NodeKind_Symbol:
+		return m_symbolHeightArray[node->m_index];
+
+	case NodeKind_Sequence:
+		return m_sequenceHeightArray[node->m_index];
+
+	case NodeKind_Beacon:
+		return getHeight(((BeaconNode*)node)->m_target);
+
+	default:
+		ASSERT(false);
+		return -1;
+	}
+}
+
+// a dead end means the parser would reject the sentence (e.g. a resolver would
+// go the other way) -- the generator backs up to the last checkpoint and takes
+// another path from there. Each chunk of FlushSize is written out at a
+// checkpoint, so memory doesn't depend on the sentence size
+
+bool
+SentenceGenerator::generateSentence() {
+	m_stack.clear();
+	m_lookaheadArray.clear();
+	m_lookaheadIndex = 0;
+	m_sentence.clear();
+	m_lineLength = 0;
+	m_tokenCount = 0;
+
+	pushNode(m_nodeMgr->m_primaryStartSymbol, 0);
+	saveCheckpoint();
+
+	size_t retryCount = 0;
+
+	for (;;) {
+		SentenceStep step = continueSentence();
+		switch (step) {
+		case SentenceStep_Done:
+			return
+				emitString(m_sentence) &&
+				emitString("\n");
+
+		case SentenceStep_Checkpoint:
+			if (!emitString(m_sentence))
+				return false;
+
+			m_sentence.clear();
+			saveCheckpoint();
+			retryCount = 0;
+			break;
+
+		case SentenceStep_DeadEnd:
+			if (++retryCount >= MaxRetryCount) {
+				err::setFormatStringError(
+					"no sentence of '%s' accepted by the parser after %d attempts",
+					m_nodeMgr->m_primaryStartSymbol->m_name.sz(),
+					retryCount
+				);
+				return false;
+			}
+
+			m_sentence.clear();
+			restoreCheckpoint();
+			break;
+
+		default:
+			ASSERT(false);
+		}
+	}
+}
+
+void
+SentenceGenerator::saveCheckpoint() {
+	m_checkpoint.m_stack = m_stack;
+	m_checkpoint.m_lookaheadArray = m_lookaheadArray;
+	m_checkpoint.m_lookaheadIndex = m_lookaheadIndex;
+	m_checkpoint.m_lineLength = m_lineLength;
+	m_checkpoint.m_tokenCount = m_tokenCount;
+}
+
+void
+SentenceGenerator::restoreCheckpoint() {
+	// the random state goes on, so the retry takes another path
+
+	m_stack = m_checkpoint.m_stack;
+	m_lookaheadArray = m_checkpoint.m_lookaheadArray;
+	m_lookaheadIndex = m_checkpoint.m_lookaheadIndex;
+	m_lineLength = m_checkpoint.m_lineLength;
+	m_tokenCount = m_checkpoint.m_tokenCount;
+}
+
+SentenceStep
+SentenceGenerator::continueSentence() {
+	// the weights wind sentences down well before these
+
+	size_t stackLimit = m_cmdLine->m_sentenceDepthLimit * 64;
+	size_t tokenLimit = m_cmdLine->m_sentenceSize * 4 + 1024;
+
+	while (!m_stack.isEmpty()) {
+		if (m_stack.getCount() > stackLimit || m_tokenCount > tokenLimit)
+			return SentenceStep_DeadEnd;
+
+		if (m_sentence.getLength() >= FlushSize)
+			return SentenceStep_Checkpoint;
+
+		SentenceStackEntry entry = m_stack.getBackAndPop();
+		GrammarNode* node = entry.m_node;
+		SequenceNode* sequence;
+		bool result;
+
+		switch (node->m_nodeKind) {
+		case NodeKind_Token:
+			result = matchToken((SymbolNode*)node);
+			if (!result)
+				return SentenceStep_DeadEnd;
+
+			break;
+
+		case NodeKind_Symbol:
+			result = expandSymbol((SymbolNode*)node, entry.m_depth);
+			if (!result)
+				return SentenceStep_DeadEnd;
+
+			break;
+
+		case NodeKind_Sequence:
+			sequence = (SequenceNode*)node;
+			for (intptr_t i = sequence->m_sequence.getCount() - 1; i >= 0; i--)
+				pushNode(sequence->m_sequence[i], entry.m_depth);
+
+			break;
+
+		case NodeKind_Beacon:
+			pushNode(((BeaconNode*)node)->m_target, entry.m_depth);
+			break;
+
+		default: // epsilon, actions & arguments
+			break;
+		}
+	}
+
+	// whatever was picked for lookahead must be the end of the sentence
+
+	SymbolNode* lookahead = getLookahead(0);
+	return !lookahead || ((lookahead->m_flags & SymbolNodeFlag_EofToken) && !getLookahead(1)) ?
+		SentenceStep_Done :
+		SentenceStep_DeadEnd;
+}
+
+// exactly what the parser does on a symbol -- only the token it looks at is
+// picked right here, unless an earlier decision already did
+
+bool
+SentenceGenerator::expandSymbol(
+	SymbolNode* symbol,
+	size_t depth
+) {
+	SymbolNode* token = getLookahead(0);
+	if (!token) {
+		token = chooseToken(symbol, depth);
+		if (!token)
+			return false;
+
+		m_lookaheadArray.append(token);
+	}
+
+	Node* production = m_parseTable->get(symbol->m_index, token->m_index);
+	if (production && production->m_nodeKind == NodeKind_LaDfa)
+		production = predictLaDfa((LaDfaNode*)production);
+
+	if (!production) // the parser would fail here
+		return false;
+
+	pushProduction(symbol, production, depth);
+	return true;
+}
+
+bool
+SentenceGenerator::matchToken(SymbolNode* token) {
+	SymbolNode* lookahead = getLookahead(0);
+
+	if (token->m_flags & SymbolNodeFlag_AnyToken) {
+		if (!lookahead) { // pick any real token (skip eof & any)
+			size_t tokenCount = m_nodeMgr->m_tokenArray.getCount();
+			if (tokenCount <= 2)
+				return false;
+
+			lookahead = m_nodeMgr->m_tokenArray[2 + getRandom() % (tokenCount - 2)];
+			m_lookaheadArray.append(lookahead);
+		} else if (lookahead->m_flags & SymbolNodeFlag_EofToken) { // EOF does not match ANY
+			return false;
+		}
+	} else if (!lookahead) {
+		lookahead = token;
+		m_lookaheadArray.append(token);
+	} else if (lookahead != token) {
+		return false;
+	}
+
+	emitToken(lookahead);
+
+	m_lookaheadIndex++;
+	if (m_lookaheadIndex == m_lookaheadArray.getCount()) {
+		m_lookaheadArray.clear();
+		m_lookaheadIndex = 0;
+	}
+
+	return true;
+}
+
+void
+SentenceGenerator::pushProduction(
+	SymbolNode* symbol,
+	Node* production,
+	size_t depth
+) {
+	// right-recursive loops (e.g. '*' temp symbols) iterate at the same depth,
+	// so list length doesn't eat depth
+
+	if (production->m_nodeKind == NodeKind_Sequence) {
+		SequenceNode* sequence = (SequenceNode*)production;
+		size_t count = sequence->m_sequence.getCount();
+		if (count && sequence->m_sequence[count - 1] == symbol) {
+			pushNode(symbol, depth);
+			for (intptr_t i = count - 2; i >= 0; i--)
+				pushNode(sequence->m_sequence[i], depth + 1);
+
+			return;
+		}
+	}
+
+	pushNode((GrammarNode*)production, depth + 1);
+}
+
+void
+SentenceGenerator::pushNode(
+	GrammarNode* node,
+	size_t depth
+) {
+	SentenceStackEntry entry = { node, depth };
+	m_stack.append(entry);
+}
+
+// picks one of the tokens the parser accepts on the symbol: first a production
+// (by weight), then a token predicting it
+
+SymbolNode*
+SentenceGenerator::chooseToken(
+	SymbolNode* symbol,
+	size_t depth
+) {
+	const sl::Array<ParseTableEntry>& row = m_parseTable->getRow(symbol->m_index);
+	size_t count = row.getCount();
+
+	// tokens from FOLLOW are only good if they can come next in this context
+
+	bool isNullable = symbol->isNullable();
+	sl::BitMap nextTokenSet;
+	if (isNullable)
+		calcNextTokenSet(&nextTokenSet);
+
+	bool isCorpusLoop = m_stack.isEmpty(); // the trailing loop of the start symbol
+
+	sl::Array<size_t> candidateArray; // row entry indexes
+	sl::Array<Node*> productionArray;
+	sl::Array<size_t> weightArray;
+	size_t totalWeight = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		size_t tokenIndex = row[i].m_tokenIndex;
+		if (tokenIndex == 1) // lexers never yield anytoken
+			continue;
+
+		bool isLive =
+			symbol->m_firstSet.getBit(tokenIndex) ||
+			(isNullable && nextTokenSet.getBit(tokenIndex));
+
+		if (!isLive)
+			continue;
+
+		candidateArray.append(i);
+
+		Node* production = row[i].m_production;
+		size_t productionCount = productionArray.getCount();
+		size_t j = 0;
+		while (j < productionCount && productionArray[j] != production)
+			j++;
+
+		if (j == productionCount) {
+			size_t weight = getProductionWeight(symbol, production, depth, isCorpusLoop);
+			productionArray.append(production);
+			weightArray.append(weight);
+			totalWeight += weight;
+		}
+	}
+
+	if (candidateArray.isEmpty())
+		return NULL;
+
+	size_t productionCount = productionArray.getCount();
+	size_t productionIdx = productionCount - 1;
+
+	if (!totalWeight) { // out of good options; the hard limits will catch a runaway
+		productionIdx = getRandom() % productionCount;
+	} else {
+		size_t r = getRandom() % totalWeight;
+		for (size_t i = 0; i < productionCount; i++) {
+			if (r < weightArray[i]) {
+				productionIdx = i;
+				break;
+			}
+
+			r -= weightArray[i];
+		}
+	}
+
+	Node* production = productionArray[productionIdx];
+	size_t candidateCount = candidateArray.getCount();
+	size_t tokenCount = 0;
+	for (size_t i = 0; i < candidateCount; i++)
+		if (row[candidateArray[i]].m_production == production)
+			tokenCount++;
+
+	size_t r = getRandom() % tokenCount;
+	for (size_t i = 0; i < candidateCount; i++) {
+		const ParseTableEntry& entry = row[candidateArray[i]];
+		if (entry.m_production == production && !r--)
+			return m_nodeMgr->m_tokenArray[entry.m_tokenIndex];
+	}
+
+	ASSERT(false);
+	return NULL;
+}
+
+// tokens which can follow the symbol just popped off the stack
+
+void
+SentenceGenerator::calcNextTokenSet(sl::BitMap* tokenSet) {
+	tokenSet->setBitCount(m_nodeMgr->m_tokenArray.getCount());
+
+	for (intptr_t i = m_stack.getCount() - 1; i >= 0; i--) {
+		GrammarNode* node = m_stack[i].m_node;
+		tokenSet->mergeCmp<sl::BitMapOr>(node->m_firstSet);
+		if (!node->isNullable())
+			return;
+	}
+
+	tokenSet->setBit(0); // the sentence may end here
+}
+
+// walks the lookahead DFA the way the generated laDfa() does; lookahead tokens
+// not picked yet are picked among the transitions. Resolvers can't be run at
+// this point, so they are assumed to fail
+
+Node*
+SentenceGenerator::predictLaDfa(LaDfaNode* node) {
+	size_t i = 0;
+
+	for (;;) {
+		if (node->m_resolver) {
+			Node* elseNode = node->m_resolverElse;
+			if (!elseNode)
+				return node->m_production;
+
+			if (elseNode->m_nodeKind != NodeKind_LaDfa)
+				return elseNode;
+
+			node = (LaDfaNode*)elseNode;
+			continue;
+		}
+
+		if (node->m_flags & LaDfaNodeFlag_Leaf)
+			return node->m_production;
+
+		size_t count = node->m_transitionArray.getCount();
+		SymbolNode* token = getLookahead(i);
+		if (!token) {
+			if (!count)
+				return node->m_production;
+
+			token = node->m_transitionArray[getRandom() % count].m_token;
+			m_lookaheadArray.append(token);
+		}
+
+		LaDfaNode* nextNode = NULL;
+		for (size_t j = 0; j < count; j++)
+			if (node->m_transitionArray[j].m_token == token) {
+				nextNode = node->m_transitionArray[j].m_node;
+				break;
+			}
+
+		if (!nextNode)
+			return node->m_production; // the default production (NULL if none)
+
+		node = nextNode;
+		i++;
+	}
+}
+
+// productions of minimal height always have the full weight; the rest fade out
+// linearly with depth and drop to zero once the sentence is big enough. The
+// trailing loop of the start symbol keeps going until the requested size
+
+size_t
+SentenceGenerator::getProductionWeight(
+	SymbolNode* symbol,
+	Node* production,
+	size_t depth,
+	bool isCorpusLoop
+) {
+	size_t depthLimit = m_cmdLine->m_sentenceDepthLimit;
+	size_t expandWeight = isExpanding(depth) ? depthLimit - depth : 0;
+
+	if (production->m_nodeKind == NodeKind_LaDfa) // resolved later, the height is unknown
+		return expandWeight;
+
+	if (isCorpusLoop && m_tokenCount < m_cmdLine->m_sentenceSize)
+		return production->m_nodeKind == NodeKind_Epsilon ? 0 : depthLimit;
+
+	size_t height = getHeight(production);
+	size_t minHeight = m_symbolHeightArray[symbol->m_index] - 1;
+
+	return
+		height == minHeight ? depthLimit :
+		height != -1 ? expandWeight : 0;
+}
+
+bool
+SentenceGenerator::isExpanding(size_t depth) {
+	return
+		depth < m_cmdLine->m_sentenceDepthLimit &&
+		m_tokenCount < m_cmdLine->m_sentenceSize;
+}
+
+void
+SentenceGenerator::emitToken(SymbolNode* token) {
+	if (token->m_flags & SymbolNodeFlag_EofToken)
+		return;
+
+	const sl::String& spelling = m_spellingArray[token->m_index];
+	size_t length = spelling.getLength();
+
+	if (m_lineLength && m_lineLength + length >= MaxLineLength) {
+		m_sentence += '\n';
+		m_lineLength = 0;
+	} else if (m_lineLength) {
+		m_sentence += ' ';
+		m_lineLength++;
+	}
+
+	m_sentence += spelling;
+	m_lineLength += length;
+	m_tokenCount++;
+}
+
+bool
+SentenceGenerator::emitString(const sl::StringRef& string) {
+	m_buffer += string;
+	return m_buffer.getLength() < FlushSize || flush();
+}
+
+bool
+SentenceGenerator::flush() {
+	size_t length = m_buffer.getLength();
+	if (!length)
+		return true;
+
+	size_t result = m_file.write(m_buffer, length);
+	if (result == -1)
+		return false;
+
+	m_buffer.clear();
+	return true;
+}
+
+uint32_t
+SentenceGenerator::getRandom() {
+	// xorshift64*
+
+	m_randomState ^= m_randomState >> 12;
+	m_randomState ^= m_randomState << 25;
+	m_randomState ^= m_randomState >> 27;
+	return (uint32_t)((m_randomState * 0x2545f4914f6cdd1dULL) >> 32);
+}
+
+//..............................................................................
@@ -0,0 +1,179 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "Node.h"
+#include "ParseTable.h"
+
+struct CmdLine;
+class Module;
+class NodeMgr;
+
+//..............................................................................
+
+// generates random sentences of the grammar (corpora for benchmarks & fuzzing)
+// by running the LL parser backwards: whenever the parser would look at the next
+// token, a token is picked among those the parse table (and the lookahead DFAs)
+// accept at this point, and the parser's own decision for that token is taken
+
+struct SentenceStackEntry {
+	GrammarNode* m_node;
+	size_t m_depth; // symbol nesting depth
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// the generator state at the start of the unwritten part of the sentence
+
+struct SentenceCheckpoint {
+	sl::Array<SentenceStackEntry> m_stack;
+	sl::Array<SymbolNode*> m_lookaheadArray;
+	size_t m_lookaheadIndex;
+	size_t m_lineLength;
+	size_t m_tokenCount;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+enum SentenceStep {
+	SentenceStep_Done,
+	SentenceStep_DeadEnd,
+	SentenceStep_Checkpoint, // the unwritten part is FlushSize or more
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+class SentenceGenerator {
+protected:
+	enum {
+		FlushSize     = 64 * 1024,
+		MaxLineLength = 80,
+		MaxRetryCount = 64, // per sentence
+	};
+
+protected:
+	const CmdLine* m_cmdLine;
+	NodeMgr* m_nodeMgr;
+	const ParseTable* m_parseTable;
+
+	sl::Array<size_t> m_symbolHeightArray;   // minimal derivation height (-1 if infinite)
+	sl::Array<size_t> m_sequenceHeightArray;
+	sl::Array<sl::String> m_spellingArray;   // indexed by token index
+
+	sl::Array<SentenceStackEntry> m_stack;
+	sl::Array<SymbolNode*> m_lookaheadArray; // picked, but not emitted yet
+	size_t m_lookaheadIndex;                 // the next token to emit
+
+	io::File m_file;
+	sl::String m_buffer;
+	sl::String m_sentence; // the part after the checkpoint
+	SentenceCheckpoint m_checkpoint;
+	size_t m_lineLength;
+	size_t m_tokenCount; // in the current sentence
+	uint64_t m_randomState;
+
+public:
+	SentenceGenerator(const CmdLine* cmdLine);
+
+	bool
+	generate(
+		Module* module,
+		const sl::StringRef& fileName
+	);
+
+protected:
+	bool
+	loadSpellingMap(const sl::StringRef& fileName);
+
+	void
+	calcHeights();
+
+	size_t
+	getHeight(Node* node);
+
+	bool
+	generateSentence();
+
+	void
+	saveCheckpoint();
+
+	void
+	restoreCheckpoint();
+
+	SentenceStep
+	continueSentence();
+
+	bool
+	expandSymbol(
+		SymbolNode* symbol,
+		size_t depth
+	);
+
+	bool
+	matchToken(SymbolNode* token);
+
+	void
+	pushProduction(
+		SymbolNode* symbol,
+		Node* production,
+		size_t depth
+	);
+
+	void
+	pushNode(
+		GrammarNode* node,
+		size_t depth
+	);
+
+	SymbolNode*
+	getLookahead(size_t i) {
+		i += m_lookaheadIndex;
+		return i < m_lookaheadArray.getCount() ? m_lookaheadArray[i] : NULL;
+	}
+
+	SymbolNode*
+	chooseToken(
+		SymbolNode* symbol,
+		size_t depth
+	);
+
+	void
+	calcNextTokenSet(sl::BitMap* tokenSet);
+
+	Node*
+	predictLaDfa(LaDfaNode* node);
+
+	size_t
+	getProductionWeight(
+		SymbolNode* symbol,
+		Node* production,
+		size_t depth,
+		bool isCorpusLoop
+	);
+
+	bool
+	isExpanding(size_t depth);
+
+	void
+	emitToken(SymbolNode* token);
+
+	bool
+	emitString(const sl::StringRef& string);
+
+	bool
+	flush();
+
+	uint32_t
+	getRandom();
+};
+
+//..............................................................................
@@ -0,0 +1,200 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "ShardMap.h"
+#include "NodeMgr.h"
+
+//..............................................................................
+
+// weights approximate the size of the generated text
+
+enum {
+	ShardWeight_Func       = 64, // signature, symbol declaration, #line-s
+	ShardWeight_Transition = 48, // case label & production assignment
+};
+
+struct ShardItem {
+	ShardFunc m_func;
+	size_t m_index;
+	size_t m_weight;
+};
+
+static
+int
+cmpShardItemWeight(
+	const void* p1,
+	const void* p2
+) {
+	const ShardItem* item1 = (const ShardItem*)p1;
+	const ShardItem* item2 = (const ShardItem*)p2;
+
+	// heaviest first; ties are broken by function kind & index, so the map is
+	// the same on every platform
+
+	return
+		item1->m_weight < item2->m_weight ? 1 :
+		item1->m_weight > item2->m_weight ? -1 :
+		item1->m_func < item2->m_func ? -1 :
+		item1->m_func > item2->m_func ? 1 :
+		item1->m_index < item2->m_index ? -1 :
+		item1->m_index > item2->m_index ? 1 : 0;
+}
+
+static
+void
+addShardItem(
+	sl::Array<ShardItem>* itemArray,
+	ShardFunc func,
+	size_t index,
+	size_t weight
+) {
+	ShardItem item;
+	item.m_func = func;
+	item.m_index = index;
+	item.m_weight = ShardWeight_Func + weight;
+	itemArray->append(item);
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+void
+ShardMap::clear() {
+	m_shardCount = 1;
+
+	for (size_t i = 0; i < ShardFunc__Count; i++)
+		m_shardArray[i].clear();
+}
+
+void
+ShardMap::build(
+	NodeMgr* nodeMgr,
+	size_t shardCount
+) {
+	m_shardCount = shardCount ? shardCount : 1;
+
+	sl::Array<ShardItem> itemArray;
+
+	sl::Iterator<ActionNode> actionIt = nodeMgr->m_actionList.getHead();
+	for (size_t i = 0; actionIt; actionIt++, i++)
+		addShardItem(&itemArray, ShardFunc_Action, i, actionIt->m_userCode.getLength());
+
+	sl::Iterator<ArgumentNode> argumentIt = nodeMgr->m_argumentList.getHead();
+	for (size_t i = 0; argumentIt; argumentIt++, i++) {
+		size_t weight = 0;
+		sl::BoxIterator<sl::String> valueIt = argumentIt->m_argValueList.getHead();
+		for (; valueIt; valueIt++)
+			weight += ShardWeight_Func + valueIt->getLength();
+
+		addShardItem(&itemArray, ShardFunc_Argument, i, weight);
+	}
+
+	size_t count = nodeMgr->m_enterArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		addShardItem(&itemArray, ShardFunc_Enter, i, nodeMgr->m_enterArray[i]->m_enterBlock.getLength());
+
+	count = nodeMgr->m_leaveArray.getCount();
+	for (size_t i = 0; i < count; i++)
+		addShardItem(&itemArray, ShardFunc_Leave, i, nodeMgr->m_leaveArray[i]->m_leaveBlock.getLength());
+
+	// LaDfaTable only has the nodes which survived sharing
+
+	size_t laDfaCount = 0;
+	sl::Iterator<LaDfaNode> laDfaIt = nodeMgr->m_laDfaList.getHead();
+	for (; laDfaIt; laDfaIt++)
+		if (laDfaIt->m_masterIndex != -1)
+			addShardItem(
+				&itemArray,
+				ShardFunc_LaDfa,
+				laDfaCount++,
+				ShardWeight_Transition * AXL_MAX(laDfaIt->m_transitionArray.getCount(), 1)
+			);
+
+	size_t funcCount[ShardFunc__Count] = {
+		nodeMgr->m_actionList.getCount(),
+		nodeMgr->m_argumentList.getCount(),
+		nodeMgr->m_enterArray.getCount(),
+		nodeMgr->m_leaveArray.getCount(),
+		laDfaCount,
+	};
+
+	for (size_t i = 0; i < ShardFunc__Count; i++)
+		m_shardArray[i].setCountZeroConstruct(funcCount[i]);
+
+	if (m_shardCount == 1)
+		return;
+
+	count = itemArray.getCount();
+	sl::Array<ShardItem>::Rwi itemRwi = itemArray;
+	qsort(itemRwi.p(), count, sizeof(ShardItem), cmpShardItemWeight);
+
+	sl::Array<size_t> weightArray;
+	weightArray.setCountZeroConstruct(m_shardCount);
+	sl::Array<size_t>::Rwi weightRwi = weightArray;
+
+	for (size_t i = 0; i < count; i++) {
+		const ShardItem& item = itemRwi[i];
+
+		size_t shardIndex = 1;
+		for (size_t j = 2; j < m_shardCount; j++)
+			if (weightRwi[j] < weightRwi[shardIndex])
+				shardIndex = j;
+
+		m_shardArray[item.m_func].p()[item.m_index] = shardIndex;
+		weightRwi[shardIndex] += item.m_weight;
+	}
+}
+
+void
+ShardMap::luaExport(lua::LuaState* luaState) {
+	luaState->setGlobalInteger("ShardCount", m_shardCount);
+	luaState->createTable(m_shardCount);
+
+	for (size_t i = 0; i < m_shardCount; i++) {
+		luaExportShard(luaState, i);
+		luaState->setArrayElement(i + 1);
+	}
+
+	luaState->setGlobal("ShardTable");
+}
+
+void
+ShardMap::luaExportShard(
+	lua::LuaState* luaState,
+	size_t shardIndex
+) {
+	static const char* const nameTable[ShardFunc__Count] = {
+		"actionTable",
+		"argumentTable",
+		"enterTable",
+		"leaveTable",
+		"laDfaTable",
+	};
+
+	luaState->createTable(0, ShardFunc__Count);
+
+	for (size_t i = 0; i < ShardFunc__Count; i++) {
+		const sl::Array<size_t>& shardArray = m_shardArray[i];
+		size_t count = shardArray.getCount();
+
+		luaState->createTable(0);
+
+		// 1-based indices into the respective global tables
+
+		for (size_t j = 0, k = 1; j < count; j++)
+			if (shardArray[j] == shardIndex)
+				luaState->setArrayElementInteger(k++, j + 1);
+
+		luaState->setMember(nameTable[i]);
+	}
+}
+
+//..............................................................................
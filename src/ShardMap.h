@@ -0,0 +1,78 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+class NodeMgr;
+
+//..............................................................................
+
+// generated per-node functions (action_N, argument_N, enter_*, leave_*, laDfa_N)
+
+enum ShardFunc {
+	ShardFunc_Action,
+	ShardFunc_Argument,
+	ShardFunc_Enter,
+	ShardFunc_Leave,
+	ShardFunc_LaDfa,
+	ShardFunc__Count,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// distributes generated functions across translation units (shards). Shard 0
+// keeps the tables and dispatchers; with more than one shard, the functions go
+// to shards 1..N-1, largest first, each to the currently lightest shard
+
+class ShardMap {
+protected:
+	size_t m_shardCount;
+	sl::Array<size_t> m_shardArray[ShardFunc__Count]; // function index -> shard index
+
+public:
+	ShardMap() {
+		m_shardCount = 1;
+	}
+
+	size_t
+	getShardCount() const {
+		return m_shardCount;
+	}
+
+	size_t
+	getShard(
+		ShardFunc func,
+		size_t index
+	) const {
+		return m_shardArray[func][index];
+	}
+
+	void
+	clear();
+
+	void
+	build(
+		NodeMgr* nodeMgr,
+		size_t shardCount
+	);
+
+	void
+	luaExport(lua::LuaState* luaState);
+
+protected:
+	void
+	luaExportShard(
+		lua::LuaState* luaState,
+		size_t shardIndex
+	);
+};
+
+//..............................................................................
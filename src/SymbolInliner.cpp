@@ -0,0 +1,224 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "SymbolInliner.h"
+
+//..............................................................................
+
+SymbolInliner::SymbolInliner(NodeMgr* nodeMgr) {
+	m_nodeMgr = nodeMgr;
+	m_inlineCount = 0;
+}
+
+size_t
+SymbolInliner::inlineSymbols() {
+	size_t symbolCount = m_nodeMgr->m_symbolArray.getCount();
+	m_targetArray.setCountZeroConstruct(symbolCount);
+	m_inlineCount = 0;
+
+	bool hasTargets = false;
+	sl::Array<GrammarNode*>::Rwi rwi = m_targetArray;
+
+	sl::Iterator<SymbolNode> symbolIt = m_nodeMgr->m_namedSymbolList.getHead();
+	for (; symbolIt; symbolIt++) {
+		SymbolNode* symbol = *symbolIt;
+		if (isInlinable(symbol)) {
+			rwi[symbol->m_index] = symbol->m_productionArray[0];
+			hasTargets = true;
+		}
+	}
+
+	if (!hasTargets)
+		return 0;
+
+	for (size_t i = 0; i < symbolCount; i++)
+		inlineProductions(m_nodeMgr->m_symbolArray[i]);
+
+	sl::Iterator<SequenceNode> sequenceIt = m_nodeMgr->m_sequenceList.getHead();
+	for (; sequenceIt; sequenceIt++)
+		inlineSequence(*sequenceIt);
+
+	return m_inlineCount;
+}
+
+bool
+SymbolInliner::isInlinable(SymbolNode* symbol) {
+	if (symbol->m_productionArray.getCount() != 1 ||
+		symbol->m_resolver ||
+		symbol->m_synchronizer ||
+		(symbol->m_flags & (SymbolNodeFlag_Pragma | SymbolNodeFlag_Start)) ||
+		!symbol->m_valueBlock.isEmpty() ||
+		!symbol->m_paramBlock.isEmpty() ||
+		!symbol->m_localBlock.isEmpty() ||
+		!symbol->m_enterBlock.isEmpty() ||
+		!symbol->m_leaveBlock.isEmpty())
+		return false;
+
+	GrammarNode* production = symbol->m_productionArray[0];
+	if (production->m_nodeKind == NodeKind_Epsilon || production == symbol)
+		return false;
+
+	// actions & locators in the production run in the context of this symbol
+
+	return isPure(production);
+}
+
+bool
+SymbolInliner::isTempSymbol(SymbolNode* symbol) {
+	size_t tempFirst =
+		m_nodeMgr->m_namedSymbolList.getCount() +
+		m_nodeMgr->m_catchSymbolList.getCount() +
+		m_nodeMgr->m_resolverSymbolList.getCount();
+
+	return
+		symbol->m_index >= tempFirst &&
+		symbol->m_index < tempFirst + m_nodeMgr->m_tempSymbolList.getCount();
+}
+
+bool
+SymbolInliner::isPure(GrammarNode* node) {
+	if (node->m_flags & NodeFlag_RecursionStopper)
+		return true;
+
+	bool result = true;
+	size_t count;
+
+	switch (node->m_nodeKind) {
+	case NodeKind_Epsilon:
+	case NodeKind_Token:
+		break;
+
+	case NodeKind_Symbol: {
+		SymbolNode* symbol = (SymbolNode*)node;
+		if (!isTempSymbol(symbol)) // named symbols have their own context
+			break;
+
+		symbol->m_flags |= NodeFlag_RecursionStopper;
+
+		count = symbol->m_productionArray.getCount();
+		for (size_t i = 0; i < count && result; i++)
+			result = isPure(symbol->m_productionArray[i]);
+
+		symbol->m_flags &= ~NodeFlag_RecursionStopper;
+		break;
+		}
+
+	case NodeKind_Sequence: {
+		SequenceNode* sequence = (SequenceNode*)node;
+		sequence->m_flags |= NodeFlag_RecursionStopper;
+
+		count = sequence->m_sequence.getCount();
+		for (size_t i = 0; i < count && result; i++)
+			result = isPure(sequence->m_sequence[i]);
+
+		sequence->m_flags &= ~NodeFlag_RecursionStopper;
+		break;
+		}
+
+	default: // actions, arguments, beacons
+		result = false;
+	}
+
+	return result;
+}
+
+GrammarNode*
+SymbolInliner::getTarget(GrammarNode* node) {
+	// follow chains of pass-through symbols (bounded, so cycles are harmless)
+
+	size_t symbolCount = m_targetArray.getCount();
+	for (size_t i = 0; i < symbolCount && node->m_nodeKind == NodeKind_Symbol; i++) {
+		ASSERT(node->m_index < symbolCount);
+
+		GrammarNode* target = m_targetArray[node->m_index];
+		if (!target)
+			break;
+
+		node = target;
+	}
+
+	return node;
+}
+
+void
+SymbolInliner::inlineProductions(SymbolNode* symbol) {
+	size_t count = symbol->m_productionArray.getCount();
+	sl::Array<GrammarNode*>::Rwi rwi = symbol->m_productionArray;
+	for (size_t i = 0; i < count; i++) {
+		GrammarNode* target = getTarget(rwi[i]);
+		if (target != rwi[i]) {
+			rwi[i] = target;
+			m_inlineCount++;
+		}
+	}
+}
+
+void
+SymbolInliner::inlineSequence(SequenceNode* sequence) {
+	size_t count = sequence->m_sequence.getCount();
+	size_t i = 0;
+
+	for (; i < count; i++) {
+		GrammarNode* child = sequence->m_sequence[i];
+		if (getTarget(child) != child)
+			break;
+	}
+
+	if (i == count)
+		return;
+
+	sl::Array<GrammarNode*> array;
+	sequence->m_flags |= NodeFlag_RecursionStopper;
+
+	for (i = 0; i < count; i++)
+		appendInlined(&array, sequence->m_sequence[i]);
+
+	sequence->m_flags &= ~NodeFlag_RecursionStopper;
+	sequence->m_sequence = array;
+}
+
+void
+SymbolInliner::appendInlined(
+	sl::Array<GrammarNode*>* array,
+	GrammarNode* node
+) {
+	GrammarNode* target = getTarget(node);
+	if (target == node) {
+		array->append(node);
+		return;
+	}
+
+	if (target->m_nodeKind != NodeKind_Sequence) {
+		array->append(target);
+		m_inlineCount++;
+		return;
+	}
+
+	if (target->m_flags & NodeFlag_RecursionStopper) { // self-referencing, keep the symbol
+		array->append(node);
+		return;
+	}
+
+	// splice
+
+	SequenceNode* sequence = (SequenceNode*)target;
+	sequence->m_flags |= NodeFlag_RecursionStopper;
+
+	size_t count = sequence->m_sequence.getCount();
+	for (size_t i = 0; i < count; i++)
+		appendInlined(array, sequence->m_sequence[i]);
+
+	sequence->m_flags &= ~NodeFlag_RecursionStopper;
+	m_inlineCount++;
+}
+
+//..............................................................................
@@ -0,0 +1,63 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "NodeMgr.h"
+
+//..............................................................................
+
+// replaces direct references to pass-through symbols (a single production, no
+// user code anywhere in it, no specifiers) with that production; sequences are
+// spliced into the referencing sequences. FIRST sets and nullability are the
+// same, and such a symbol never has conflicts of its own, so LL(k) decisions
+// of the callers are preserved. Symbols themselves stay in the symbol table
+// (SymbolKind values are public), as do locator (beacon) references to them
+
+class SymbolInliner {
+protected:
+	NodeMgr* m_nodeMgr;
+	sl::Array<GrammarNode*> m_targetArray; // symbol index -> inlined production (or NULL)
+	size_t m_inlineCount;
+
+public:
+	SymbolInliner(NodeMgr* nodeMgr);
+
+	size_t
+	inlineSymbols(); // returns the number of replaced references
+
+protected:
+	bool
+	isInlinable(SymbolNode* symbol);
+
+	bool
+	isPure(GrammarNode* node);
+
+	bool
+	isTempSymbol(SymbolNode* symbol);
+
+	GrammarNode*
+	getTarget(GrammarNode* node);
+
+	void
+	inlineProductions(SymbolNode* symbol);
+
+	void
+	inlineSequence(SequenceNode* sequence);
+
+	void
+	appendInlined(
+		sl::Array<GrammarNode*>* array,
+		GrammarNode* node
+	);
+};
+
+//..............................................................................
@@ -0,0 +1,54 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+// jobCount of 0 means one thread per CPU; never more threads than work items
+
+inline
+size_t
+getWorkerThreadCount(
+	size_t jobCount,
+	size_t itemCount
+) {
+	size_t threadCount = jobCount ? jobCount : std::thread::hardware_concurrency();
+	return threadCount < itemCount ? threadCount : itemCount;
+}
+
+// runs func(job) on threadCount threads, the calling thread included; workers
+// are expected to pull their work items off the job until none are left
+
+template <typename Job>
+void
+runWorkerPool(
+	size_t threadCount,
+	void (*func)(Job*),
+	Job* job
+) {
+	if (threadCount <= 1) {
+		func(job);
+		return;
+	}
+
+	std::vector<std::thread> threadArray;
+	threadArray.reserve(threadCount - 1);
+	for (size_t i = 1; i < threadCount; i++)
+		threadArray.emplace_back(func, job);
+
+	func(job); // this thread is a worker, too
+
+	for (size_t i = 0; i < threadArray.size(); i++)
+		threadArray[i].join();
+}
+
+//..............................................................................
@@ -12,6 +12,7 @@
 #include "pch.h"
 #include "Parser.h"
 #include "Generator.h"
+#include "SentenceGenerator.h"
 #include "CmdLine.h"
 #include "version.h"
 
@@ -143,21 +144,29 @@ main(
 	if (cmdLine.m_flags & CmdLineFlag_Verbose)
 		module.trace();
 
-	Generator generator(&cmdLine);
-	generator.prepare(&module);
-
-	ASSERT(cmdLine.m_outputFileNameList.getCount() == cmdLine.m_frameFileNameList.getCount());
-	sl::BoxIterator<sl::String> outputFileNameIt = cmdLine.m_outputFileNameList.getHead();
-	sl::BoxIterator<sl::String> frameFileNameIt = cmdLine.m_frameFileNameList.getHead();
+	if (!cmdLine.m_lookaheadReportFileName.isEmpty()) {
+		result = module.writeLookaheadReport(cmdLine.m_lookaheadReportFileName);
+		if (!result) {
+			printf("%s\n", err::getLastErrorDescription().sz());
+			return ErrorCode_BuildFailure;
+		}
+	}
 
-	for (; outputFileNameIt && frameFileNameIt; outputFileNameIt++, frameFileNameIt++) {
-		result = generator.generate(*outputFileNameIt, *frameFileNameIt);
+	if (!cmdLine.m_sentenceFileName.isEmpty()) {
+		SentenceGenerator sentenceGenerator(&cmdLine);
+		result = sentenceGenerator.generate(&module, cmdLine.m_sentenceFileName);
 		if (!result) {
 			printf("%s\n", err::getLastErrorDescription().sz());
 			return ErrorCode_GenerateFailure;
 		}
 	}
 
+	result = generateOutputFiles(&cmdLine, &module);
+	if (!result) {
+		printf("%s\n", err::getLastErrorDescription().sz());
+		return ErrorCode_GenerateFailure;
+	}
+
 	return ErrorCode_Success;
 }
 
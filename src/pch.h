@@ -19,4 +19,8 @@
 #include "axl_sl_CmdLineParser.h"
 #include "axl_io_FilePathUtils.h"
 
+#include <thread>
+#include <atomic>
+#include <vector>
+
 using namespace axl;
@@ -0,0 +1,109 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "TokenStream.h"
+
+//..............................................................................
+
+// parses the same corpus over and over again; after the warm-up, neither the
+// node allocator, the token pool nor the parser itself may allocate
+
+template <typename Parser>
+bool
+parseCorpus(
+	Parser* parser,
+	const sl::Array<sl::Array<int> >& documentArray,
+	TokenAllocCounter* tokenAllocCounter
+) {
+	size_t count = documentArray.getCount();
+	for (size_t i = 0; i < count; i++) {
+		bool result = parseTokenStream(parser, documentArray[i], tokenAllocCounter);
+		if (!result)
+			return false;
+	}
+
+	return true;
+}
+
+template <typename Parser>
+bool
+testSteadyState(
+	const sl::StringRef& fileName,
+	const TokenSpelling* spellingTable,
+	size_t warmUpCount,
+	size_t iterationCount
+) {
+	sl::Array<sl::Array<int> > documentArray;
+	bool result = loadTokenStream(&documentArray, fileName, spellingTable);
+	if (!result)
+		return false;
+
+	size_t totalCount = documentArray.getCount();
+	size_t count = filterTokenStreams<Parser>(&documentArray);
+	if (!count) {
+		err::setFormatStringError("%s: no document is accepted by the parser", fileName.sz());
+		return false;
+	}
+
+	size_t tokenCount = 0;
+	for (size_t i = 0; i < count; i++)
+		tokenCount += documentArray[i].getCount();
+
+	Parser parser;
+	llk::NodeAllocator<Parser>* nodeAllocator = llk::getCurrentThreadNodeAllocator<Parser>();
+	TokenAllocCounter tokenAllocCounter;
+
+	for (size_t i = 0; i < warmUpCount; i++) {
+		result = parseCorpus(&parser, documentArray, &tokenAllocCounter);
+		if (!result)
+			return false;
+	}
+
+	typename Parser::AllocStats stats = parser.getAllocStats();
+	size_t nodeAllocCount = nodeAllocator->getAllocCount();
+	size_t tokenAllocCount = tokenAllocCounter.getAllocCount();
+
+	for (size_t i = 0; i < iterationCount; i++) {
+		result = parseCorpus(&parser, documentArray, &tokenAllocCounter);
+		if (!result)
+			return false;
+	}
+
+	nodeAllocCount = nodeAllocator->getAllocCount() - nodeAllocCount;
+	tokenAllocCount = tokenAllocCounter.getAllocCount() - tokenAllocCount;
+	size_t stackAllocCount = parser.getAllocStats().m_stackAllocCount - stats.m_stackAllocCount;
+	size_t syncAllocCount = parser.getAllocStats().m_syncAllocCount - stats.m_syncAllocCount;
+
+	printf(
+		"%s: %d of %d document(s), %d tokens x %d iterations, allocations: "
+		"%d node(s), %d token(s), %d stack(s), %d sync set\n",
+		fileName.sz(),
+		count,
+		totalCount,
+		tokenCount,
+		iterationCount,
+		nodeAllocCount,
+		tokenAllocCount,
+		stackAllocCount,
+		syncAllocCount
+	);
+
+	if (nodeAllocCount || tokenAllocCount || stackAllocCount || syncAllocCount) {
+		err::setError("steady-state parsing is not allocation-free");
+		return false;
+	}
+
+	return true;
+}
+
+//..............................................................................
@@ -0,0 +1,39 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "AllocTest.h"
+
+namespace c_grammar {
+
+#include "c.llk.token.h"
+#include "c.llk.h"
+#include "c.llk.cpp"
+
+} // namespace c_grammar
+
+//..............................................................................
+
+bool
+testSteadyState_c(
+	const sl::StringRef& fileName,
+	size_t warmUpCount,
+	size_t iterationCount
+) {
+	return testSteadyState<c_grammar::Parser>(
+		fileName,
+		c_grammar::g_tokenSpellingTable,
+		warmUpCount,
+		iterationCount
+	);
+}
+
+//..............................................................................
@@ -0,0 +1,39 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "AllocTest.h"
+
+namespace jancy_grammar {
+
+#include "jancy.llk.token.h"
+#include "jancy.llk.h"
+#include "jancy.llk.cpp"
+
+} // namespace jancy_grammar
+
+//..............................................................................
+
+bool
+testSteadyState_jancy(
+	const sl::StringRef& fileName,
+	size_t warmUpCount,
+	size_t iterationCount
+) {
+	return testSteadyState<jancy_grammar::Parser>(
+		fileName,
+		jancy_grammar::g_tokenSpellingTable,
+		warmUpCount,
+		iterationCount
+	);
+}
+
+//..............................................................................
@@ -0,0 +1,83 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+
+//..............................................................................
+
+typedef
+bool
+TestFunc(
+	const sl::StringRef& fileName,
+	size_t warmUpCount,
+	size_t iterationCount
+);
+
+TestFunc testSteadyState_c;
+TestFunc testSteadyState_java;
+TestFunc testSteadyState_lua;
+TestFunc testSteadyState_jancy;
+
+struct TestEntry {
+	const char* m_grammarName;
+	TestFunc* m_func;
+};
+
+static const TestEntry g_testTable[] = {
+	{ "c",     testSteadyState_c },
+	{ "java",  testSteadyState_java },
+	{ "lua",   testSteadyState_lua },
+	{ "jancy", testSteadyState_jancy },
+};
+
+enum {
+	WarmUpCount           = 4,
+	DefaultIterationCount = 1000,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+int
+main(
+	int argc,
+	char* argv[]
+) {
+	lex::registerParseErrorProvider();
+
+	if (argc < 3) {
+		printf("Usage: graco_test_alloc <grammar> <token-stream-file> [<iteration-count>]\n");
+		return -1;
+	}
+
+	const TestEntry* entry = NULL;
+	for (size_t i = 0; i < countof(g_testTable); i++)
+		if (strcmp(argv[1], g_testTable[i].m_grammarName) == 0) {
+			entry = &g_testTable[i];
+			break;
+		}
+
+	if (!entry) {
+		printf("error: unknown grammar '%s'\n", argv[1]);
+		return -1;
+	}
+
+	size_t iterationCount = argc > 3 ? atoi(argv[3]) : DefaultIterationCount;
+
+	bool result = entry->m_func(argv[2], WarmUpCount, iterationCount);
+	if (!result) {
+		printf("error: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	return 0;
+}
+
+//..............................................................................
@@ -0,0 +1,78 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "TokenStream.h"
+
+//..............................................................................
+
+struct BenchResult {
+	size_t m_tokenCount;
+	uint64_t m_time; // in nanoseconds
+	size_t m_nodeAllocCount;
+	size_t m_stackAllocCount;
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// parses all documents of the corpus (those accepted by the parser) over and
+// over again until at least tokenCount tokens are consumed; allocations include
+// the first (cold) iteration
+
+template <typename Parser>
+bool
+runBenchmark(
+	const sl::StringRef& fileName,
+	const TokenSpelling* spellingTable,
+	size_t tokenCount,
+	BenchResult* benchResult
+) {
+	sl::Array<sl::Array<int> > documentArray;
+	bool result = loadTokenStream(&documentArray, fileName, spellingTable);
+	if (!result)
+		return false;
+
+	size_t documentCount = filterTokenStreams<Parser>(&documentArray);
+	if (!documentCount) {
+		err::setFormatStringError("%s: no document is accepted by the parser", fileName.sz());
+		return false;
+	}
+
+	size_t streamLength = documentCount; // including eof-s
+	for (size_t i = 0; i < documentCount; i++)
+		streamLength += documentArray[i].getCount();
+
+	size_t iterationCount = (tokenCount + streamLength - 1) / streamLength;
+
+	Parser parser;
+	llk::NodeAllocator<Parser>* nodeAllocator = llk::getCurrentThreadNodeAllocator<Parser>();
+	size_t nodeAllocCount = nodeAllocator->getAllocCount();
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < iterationCount; i++)
+		for (size_t j = 0; j < documentCount; j++) {
+			result = parseTokenStream(&parser, documentArray[j]);
+			if (!result)
+				return false;
+		}
+
+	std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+
+	benchResult->m_tokenCount = iterationCount * streamLength;
+	benchResult->m_time = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	benchResult->m_nodeAllocCount = nodeAllocator->getAllocCount() - nodeAllocCount;
+	benchResult->m_stackAllocCount = parser.getAllocStats().m_stackAllocCount;
+	return true;
+}
+
+//..............................................................................
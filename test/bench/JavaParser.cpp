@@ -0,0 +1,39 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "Bench.h"
+
+namespace java_grammar {
+
+#include "java.llk.token.h"
+#include "java.llk.h"
+#include "java.llk.cpp"
+
+} // namespace java_grammar
+
+//..............................................................................
+
+bool
+runBenchmark_java(
+	const sl::StringRef& fileName,
+	size_t tokenCount,
+	BenchResult* benchResult
+) {
+	return runBenchmark<java_grammar::Parser>(
+		fileName,
+		java_grammar::g_tokenSpellingTable,
+		tokenCount,
+		benchResult
+	);
+}
+
+//..............................................................................
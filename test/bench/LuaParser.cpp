@@ -0,0 +1,39 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "Bench.h"
+
+namespace lua_grammar {
+
+#include "lua.llk.token.h"
+#include "lua.llk.h"
+#include "lua.llk.cpp"
+
+} // namespace lua_grammar
+
+//..............................................................................
+
+bool
+runBenchmark_lua(
+	const sl::StringRef& fileName,
+	size_t tokenCount,
+	BenchResult* benchResult
+) {
+	return runBenchmark<lua_grammar::Parser>(
+		fileName,
+		lua_grammar::g_tokenSpellingTable,
+		tokenCount,
+		benchResult
+	);
+}
+
+//..............................................................................
@@ -0,0 +1,122 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "Bench.h"
+
+//..............................................................................
+
+typedef
+bool
+BenchFunc(
+	const sl::StringRef& fileName,
+	size_t tokenCount,
+	BenchResult* benchResult
+);
+
+BenchFunc runBenchmark_c;
+BenchFunc runBenchmark_java;
+BenchFunc runBenchmark_lua;
+BenchFunc runBenchmark_jancy;
+
+struct BenchEntry {
+	const char* m_grammarName;
+	BenchFunc* m_func;
+};
+
+static const BenchEntry g_benchTable[] = {
+	{ "c",     runBenchmark_c },
+	{ "java",  runBenchmark_java },
+	{ "lua",   runBenchmark_lua },
+	{ "jancy", runBenchmark_jancy },
+};
+
+enum {
+	DefaultTokenCount = 1000000,
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// the whole process is dedicated to a single grammar, so the process-wide
+// peak is the peak of the benchmark
+
+size_t
+getPeakMemorySize() {
+#if (_AXL_OS_WIN)
+	PROCESS_MEMORY_COUNTERS counters = { sizeof(counters) };
+	::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+	::getrusage(RUSAGE_SELF, &usage);
+#	if (_AXL_OS_DARWIN)
+	return usage.ru_maxrss; // bytes
+#	else
+	return usage.ru_maxrss * 1024; // kilobytes
+#	endif
+#endif
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+int
+main(
+	int argc,
+	char* argv[]
+) {
+	lex::registerParseErrorProvider();
+
+	if (argc < 3) {
+		printf("Usage: graco_bench <grammar> <token-stream-file> [<token-count>]\n");
+		return -1;
+	}
+
+	const BenchEntry* entry = NULL;
+	for (size_t i = 0; i < countof(g_benchTable); i++)
+		if (strcmp(argv[1], g_benchTable[i].m_grammarName) == 0) {
+			entry = &g_benchTable[i];
+			break;
+		}
+
+	if (!entry) {
+		printf("error: unknown grammar '%s'\n", argv[1]);
+		return -1;
+	}
+
+	size_t tokenCount = argc > 3 ? atoi(argv[3]) : DefaultTokenCount;
+
+	BenchResult benchResult;
+	bool result = entry->m_func(argv[2], tokenCount, &benchResult);
+	if (!result) {
+		printf("error: %s\n", err::getLastErrorDescription().sz());
+		return -1;
+	}
+
+	double time = (double)benchResult.m_time; // ns
+	double tokens = (double)benchResult.m_tokenCount;
+
+	printf(
+		"%-6s tokens: %d, time: %.3f ms, %.3f Mtok/s, %.2f ns/token, "
+		"node allocations: %d, stack allocations: %d, peak memory: %d KB\n",
+		entry->m_grammarName,
+		benchResult.m_tokenCount,
+		time / 1000000,
+		tokens * 1000 / time,
+		time / tokens,
+		benchResult.m_nodeAllocCount,
+		benchResult.m_stackAllocCount,
+		getPeakMemorySize() / 1024
+	);
+
+	return 0;
+}
+
+//..............................................................................
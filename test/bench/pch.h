@@ -0,0 +1,28 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+#include "axl_lex_RagelLexer.h"
+#include "axl_io_MappedFile.h"
+#include "llk_Parser.h"
+
+#include <chrono>
+
+#if (_AXL_OS_WIN)
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif
+
+using namespace axl;
+
+//..............................................................................
@@ -0,0 +1,130 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#include "pch.h"
+#include "TokenStream.h"
+
+//..............................................................................
+
+static
+int
+findToken(
+	const sl::StringRef& spelling,
+	const TokenSpelling* spellingTable
+) {
+	if (spelling.getLength() == 3 && spelling[0] == '\'' && spelling[2] == '\'')
+		return (uchar_t)spelling[1];
+
+	for (const TokenSpelling* p = spellingTable; p->m_name; p++)
+		if (spelling == p->m_name)
+			return p->m_token;
+
+	return -1;
+}
+
+bool
+loadTokenStream(
+	sl::Array<sl::Array<int> >* documentArray,
+	const sl::StringRef& fileName,
+	const TokenSpelling* spellingTable
+) {
+	io::MappedFile file;
+
+	bool result = file.open(fileName, io::FileFlag_ReadOnly);
+	if (!result) {
+		err::setFormatStringError(
+			"cannot open '%s': %s",
+			fileName.sz(),
+			err::getLastErrorDescription().sz()
+		);
+		return false;
+	}
+
+	size_t size = (size_t)file.getSize();
+	const char* p = (const char*)file.view(0, size);
+	if (!p)
+		return false;
+
+	const char* end = p + size;
+	size_t line = 1;
+
+	sl::Array<int> stream;
+	documentArray->clear();
+
+	while (p < end) {
+		switch (*p) {
+		case '\n':
+			line++;
+			// fall through
+
+		case ' ':
+		case '\t':
+		case '\r':
+			p++;
+			continue;
+
+		case '#':
+			while (p < end && *p != '\n')
+				p++;
+
+			continue;
+		}
+
+		const char* spelling = p;
+		while (p < end && !isspace((uchar_t)*p))
+			p++;
+
+		sl::StringRef string(spelling, p - spelling);
+		if (string == "%%") {
+			documentArray->append(stream);
+			stream.clear();
+			continue;
+		}
+
+		int token = findToken(string, spellingTable);
+		if (token == -1) {
+			err::setFormatStringError(
+				"%s(%d): unknown token '%s'",
+				fileName.sz(),
+				line,
+				string.sz()
+			);
+			return false;
+		}
+
+		stream.append(token);
+	}
+
+	documentArray->append(stream);
+	return true;
+}
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+void
+TokenAllocCounter::addToken(const void* token) {
+	size_t begin = 0;
+	size_t end = m_tokenArray.getCount();
+	while (begin < end) {
+		size_t mid = (begin + end) / 2;
+		if (m_tokenArray[mid] == token)
+			return;
+
+		if (m_tokenArray[mid] < token)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+
+	m_tokenArray.insert(begin, token);
+}
+
+//..............................................................................
@@ -0,0 +1,104 @@
+//..............................................................................
+//
+//  This file is part of the Graco toolkit.
+//
+//  Graco is distributed under the MIT license.
+//  For details see accompanying license.txt file,
+//  the public copy of which is also available at:
+//  http://tibbo.com/downloads/archive/graco/license.txt
+//
+//..............................................................................
+
+#pragma once
+
+//..............................................................................
+
+struct TokenSpelling {
+	const char* m_name;
+	int m_token;
+};
+
+// token stream files are whitespace-separated lists of token spellings:
+// named tokens are spelled by their names, char tokens are quoted ('+');
+// lines starting with '#' are comments; '%%' separates documents (as in the
+// corpora written by graco --sentence --sentence-count)
+
+bool
+loadTokenStream(
+	sl::Array<sl::Array<int> >* documentArray,
+	const sl::StringRef& fileName,
+	const TokenSpelling* spellingTable
+);
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+// the token pool never frees tokens, so a token address not seen before is a
+// token the pool had to allocate
+
+class TokenAllocCounter {
+protected:
+	sl::Array<const void*> m_tokenArray; // sorted
+
+public:
+	size_t
+	getAllocCount() const {
+		return m_tokenArray.getCount();
+	}
+
+	void
+	addToken(const void* token);
+};
+
+// . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . . .
+
+template <typename Parser>
+bool
+parseTokenStream(
+	Parser* parser,
+	const sl::Array<int>& stream,
+	TokenAllocCounter* tokenAllocCounter = NULL
+) {
+	typedef typename Parser::Token Token;
+
+	mem::Pool<Token>* tokenPool = parser->getTokenPool();
+	parser->create("token-stream");
+
+	size_t count = stream.getCount();
+	for (size_t i = 0; i <= count; i++) {
+		Token* token = tokenPool->get();
+		token->m_token = i < count ? stream[i] : 0; // eof
+		token->m_pos.m_col = i;
+
+		if (tokenAllocCounter)
+			tokenAllocCounter->addToken(token);
+
+		bool result = parser->consumeToken(token);
+		if (!result)
+			return false;
+	}
+
+	return true;
+}
+
+// generated sentences can still be rejected (the generator assumes resolvers
+// to fail); drops those and returns the number of documents left
+
+template <typename Parser>
+size_t
+filterTokenStreams(sl::Array<sl::Array<int> >* documentArray) {
+	Parser parser;
+	sl::Array<sl::Array<int> > acceptedArray;
+
+	size_t count = documentArray->getCount();
+	for (size_t i = 0; i < count; i++) {
+		const sl::Array<int>& stream = (*documentArray)[i];
+		bool result = parseTokenStream(&parser, stream);
+		if (result)
+			acceptedArray.append(stream);
+	}
+
+	*documentArray = acceptedArray;
+	return acceptedArray.getCount();
+}
+
+//..............................................................................
@@ -0,0 +1,89 @@
+#...............................................................................
+#
+#  This file is part of the Graco toolkit.
+#
+#  Graco is distributed under the MIT license.
+#  For details see accompanying license.txt file,
+#  the public copy of which is also available at:
+#  http://tibbo.com/downloads/archive/graco/license.txt
+#
+#...............................................................................
+
+set(GRACO_TEST_COMMON_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+file(
+	GLOB
+	GRACO_TEST_JANCY_LLK_LIST
+	${GRACO_ROOT_DIR}/test/llk/jancy/*.llk
+)
+
+# generates <name>.llk.h, <name>.llk.cpp and <name>.llk.token.h from a test
+# grammar (user code is discarded; tokens are defined by TestToken.h.in);
+# extra arguments are additional dependencies (e.g. imported grammar files)
+
+macro(
+add_graco_test_parser_step
+	_NAME
+	_INPUT_PATH
+	# ...
+)
+
+	set(_OUTPUT_PATH_BASE "${CMAKE_CURRENT_BINARY_DIR}/${_NAME}.llk")
+	set(_DEPENDENCY_LIST ${ARGN})
+
+	add_custom_command(
+		OUTPUT
+			${_OUTPUT_PATH_BASE}.h
+			${_OUTPUT_PATH_BASE}.cpp
+			${_OUTPUT_PATH_BASE}.token.h
+		MAIN_DEPENDENCY ${_INPUT_PATH}
+		COMMAND $<TARGET_FILE:graco>
+			${_INPUT_PATH}
+			--no-user-code
+			-o${_OUTPUT_PATH_BASE}.h
+			-o${_OUTPUT_PATH_BASE}.cpp
+			-o${_OUTPUT_PATH_BASE}.token.h
+			-f${GRACO_FRAME_DIR}/CppParser.h.in
+			-f${GRACO_FRAME_DIR}/CppParser.cpp.in
+			-f${GRACO_TEST_COMMON_DIR}/TestToken.h.in
+		DEPENDS
+			graco
+			${GRACO_FRAME_DIR}/CppParser.h.in
+			${GRACO_FRAME_DIR}/CppParser.cpp.in
+			${GRACO_TEST_COMMON_DIR}/TestToken.h.in
+			${_DEPENDENCY_LIST}
+		)
+endmacro()
+
+# generates <name>.tokens, a corpus of random sentences of a test grammar in
+# the token stream format (harnesses drop sentences the parser rejects);
+# extra arguments are additional dependencies
+
+macro(
+add_graco_test_corpus_step
+	_NAME
+	_INPUT_PATH
+	_SENTENCE_COUNT
+	_SENTENCE_SIZE
+	# ...
+)
+
+	set(_OUTPUT_PATH "${CMAKE_CURRENT_BINARY_DIR}/${_NAME}.tokens")
+	set(_DEPENDENCY_LIST ${ARGN})
+
+	add_custom_command(
+		OUTPUT ${_OUTPUT_PATH}
+		COMMAND $<TARGET_FILE:graco>
+			${_INPUT_PATH}
+			--no-user-code
+			-s${_OUTPUT_PATH}
+			--sentence-count=${_SENTENCE_COUNT}
+			--sentence-size=${_SENTENCE_SIZE}
+		DEPENDS
+			graco
+			${_INPUT_PATH}
+			${_DEPENDENCY_LIST}
+		)
+endmacro()
+
+#...............................................................................
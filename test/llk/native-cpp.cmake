@@ -0,0 +1,127 @@
+#...............................................................................
+#
+#  This file is part of the Graco toolkit.
+#
+#  Graco is distributed under the MIT license.
+#  For details see accompanying license.txt file,
+#  the public copy of which is also available at:
+#  http://tibbo.com/downloads/archive/graco/license.txt
+#
+#...............................................................................
+
+# usage: cmake -DGRACO=<exe> -DGRAMMAR=<llk> -DFRAME_DIR=<dir> -DOUTPUT_DIR=<dir>
+#   -P native-cpp.cmake
+#
+# generates the C++ parser with the Lua frames and natively (--native-cpp) into
+# the same paths (they end up in #line directives) and compares the results;
+# then does the same with the source frame sharded into 3 translation units.
+#
+# native runs use copies of the marked frames without CppParserUtils.lua next to
+# them, so a silent fallback to Lua fails; a copy without the marker must fail
+# too (modified frames are never emitted natively)
+
+set(_OUTPUT_BASE ${OUTPUT_DIR}/native-cpp.llk)
+set(_NATIVE_FRAME_DIR ${OUTPUT_DIR}/native-frame)
+set(_CUSTOM_FRAME_DIR ${OUTPUT_DIR}/custom-frame)
+
+macro(
+run_graco
+	_SUFFIX
+	_FRAME_DIR
+	_SHARD_COUNT
+	# ...
+)
+	set(_SHARD_ARG_LIST)
+	set(_FILE_LIST h cpp)
+
+	if(${_SHARD_COUNT} GREATER 1)
+		math(EXPR _LAST_SHARD "${_SHARD_COUNT} - 1")
+
+		foreach(_SHARD RANGE 1 ${_LAST_SHARD})
+			list(APPEND _SHARD_ARG_LIST -o${_OUTPUT_BASE}.${_SHARD}.cpp -f${_FRAME_DIR}/CppParser.cpp.in)
+			list(APPEND _FILE_LIST ${_SHARD}.cpp)
+		endforeach()
+	endif()
+
+	execute_process(
+		COMMAND ${GRACO}
+			${GRAMMAR}
+			${ARGN}
+			-o${_OUTPUT_BASE}.h
+			-o${_OUTPUT_BASE}.cpp
+			-f${_FRAME_DIR}/CppParser.h.in
+			-f${_FRAME_DIR}/CppParser.cpp.in
+			${_SHARD_ARG_LIST}
+		RESULT_VARIABLE _RESULT
+		)
+
+	if(NOT _RESULT EQUAL 0)
+		message(FATAL_ERROR "graco ${ARGN} failed: ${_RESULT}")
+	endif()
+
+	foreach(_FILE ${_FILE_LIST})
+		file(RENAME ${_OUTPUT_BASE}.${_FILE} ${_OUTPUT_BASE}.${_SUFFIX}.${_FILE})
+	endforeach()
+endmacro()
+
+macro(
+compare_outputs
+	_SUFFIX_1
+	_SUFFIX_2
+	# ...
+)
+	foreach(_FILE ${ARGN})
+		execute_process(
+			COMMAND ${CMAKE_COMMAND} -E compare_files
+				${_OUTPUT_BASE}.${_SUFFIX_1}.${_FILE}
+				${_OUTPUT_BASE}.${_SUFFIX_2}.${_FILE}
+			RESULT_VARIABLE _RESULT
+			)
+
+		if(NOT _RESULT EQUAL 0)
+			message(FATAL_ERROR "native .${_FILE} differs from the Lua frame output")
+		endif()
+	endforeach()
+endmacro()
+
+file(MAKE_DIRECTORY ${OUTPUT_DIR})
+file(MAKE_DIRECTORY ${_NATIVE_FRAME_DIR})
+file(MAKE_DIRECTORY ${_CUSTOM_FRAME_DIR})
+
+foreach(_FRAME CppParser.h.in CppParser.cpp.in)
+	file(READ ${FRAME_DIR}/${_FRAME} _CONTENTS)
+	string(FIND "${_CONTENTS}" "-- graco-native-cpp: ${_FRAME} r" _MARKER_POS)
+	if(_MARKER_POS EQUAL -1)
+		message(FATAL_ERROR "${_FRAME} has no native-cpp marker")
+	endif()
+
+	file(WRITE ${_NATIVE_FRAME_DIR}/${_FRAME} "${_CONTENTS}")
+
+	string(REPLACE "-- graco-native-cpp: " "-- " _CONTENTS "${_CONTENTS}")
+	file(WRITE ${_CUSTOM_FRAME_DIR}/${_FRAME} "${_CONTENTS}")
+endforeach()
+
+run_graco(lua ${FRAME_DIR} 1)
+run_graco(native ${_NATIVE_FRAME_DIR} 1 --native-cpp)
+compare_outputs(lua native h cpp)
+
+run_graco(lua-shard ${FRAME_DIR} 3)
+run_graco(native-shard ${_NATIVE_FRAME_DIR} 3 --native-cpp)
+compare_outputs(lua-shard native-shard h cpp 1.cpp 2.cpp)
+
+execute_process(
+	COMMAND ${GRACO}
+		${GRAMMAR}
+		--native-cpp
+		-o${_OUTPUT_BASE}.custom.h
+		-f${_CUSTOM_FRAME_DIR}/CppParser.h.in
+	RESULT_VARIABLE _RESULT
+	OUTPUT_QUIET
+	ERROR_QUIET
+	)
+
+if(_RESULT EQUAL 0)
+	message(FATAL_ERROR "a frame without the marker was emitted natively")
+endif()
+
+#...............................................................................